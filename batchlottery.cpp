@@ -0,0 +1,498 @@
+#include "batchlottery.h"
+#include "draftorder.h"
+#include "entryfile.h"
+#include "exactpickodds.h"
+#include "lotteryrules.h"
+#include "philox.h"
+#include "teamtablemodel.h"
+#include "weightedorder.h"
+
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    // The history report lists the most used odds tables and their first picks
+    const std::size_t reportTables = 8;
+    const int reportPicks = 4;
+}
+
+BatchLottery::BatchLottery(quint64 seed, bool weightedOrder, const QString &format)
+    : seed(seed), weightedOrder(weightedOrder), format(format.toLatin1())
+{
+}
+
+bool BatchLottery::isFormat(const QString &format)
+{
+    return LotteryFormats::withFormat(format.toLatin1().constData(), [](auto) {});
+}
+
+bool BatchLottery::load(const QString &path, QString &error)
+{
+    QFile file;
+    QString name;
+
+    if (path == "-")
+    {
+        if (!file.open(stdin, QIODevice::ReadOnly))
+        {
+            error = "Could not read stdin";
+            return false;
+        }
+        name = "stdin";
+    }
+    else
+    {
+        file.setFileName(path);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            error = QString("Could not open %1").arg(path);
+            return false;
+        }
+        name = QFileInfo(path).completeBaseName();
+    }
+
+    QByteArray data = file.readAll();
+
+    // JSON starts with an object or an array, everything else is read as CSV
+    QByteArray start = data.trimmed().left(1);
+    if (start == "{" || start == "[")
+        return loadJson(data, name, error);
+    return loadCsv(data, name, error);
+}
+
+// Accepts a single league, an array of leagues or {"leagues": [...]}.
+// A league is {"name": "...", "teams": [{"name": "...", "odds": 12.5}, ...]}.
+bool BatchLottery::loadJson(const QByteArray &data, const QString &fallbackName, QString &error)
+{
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(data, &parseError);
+    if (document.isNull())
+    {
+        error = QString("%1: %2 at offset %3").arg(fallbackName, parseError.errorString()).arg(parseError.offset);
+        return false;
+    }
+
+    QJsonArray list;
+    if (document.isArray())
+        list = document.array();
+    else if (document.object().contains("leagues"))
+        list = document.object().value("leagues").toArray();
+    else
+        list.append(document.object());
+
+    for (int i = 0; i < list.size(); ++i)
+    {
+        QString name = list.size() == 1 ? fallbackName : QString("%1-%2").arg(fallbackName).arg(i + 1);
+        if (!addLeague(list.at(i), name, error))
+            return false;
+    }
+    return true;
+}
+
+bool BatchLottery::addLeague(const QJsonValue &value, const QString &fallbackName, QString &error)
+{
+    QJsonObject object = value.toObject();
+    League league;
+    league.name = object.value("name").toString(fallbackName);
+
+    const QJsonArray teams = object.value("teams").toArray();
+    for (const QJsonValue &entry : teams)
+    {
+        QJsonObject team = entry.toObject();
+
+        // Odds may be written as a number or as text like "12.5%"
+        QJsonValue oddsValue = team.value("odds");
+        QString oddsText = oddsValue.isDouble() ? QString::number(oddsValue.toDouble(), 'f', 2) : oddsValue.toString();
+
+        int odds = 0;
+        if (!TeamTableModel::parseOdds(oddsText, odds))
+        {
+            error = QString("%1: team %2 has invalid odds").arg(league.name).arg(league.teams.size() + 1);
+            return false;
+        }
+
+        QString name = team.value("name").toString().trimmed();
+        if (name.isEmpty())
+            name = QString("Team %1").arg(league.teams.size() + 1);
+        league.teams.append(qMakePair(name, odds));
+    }
+
+    leagues.append(league);
+    return true;
+}
+
+// Either "team,odds" lines for a single league or "league,team,odds" lines for several.
+// Lines whose odds are not a number (like a header) are skipped.
+bool BatchLottery::loadCsv(const QByteArray &data, const QString &fallbackName, QString &error)
+{
+    QMap<QString, int> byName;
+    QTextStream stream(data);
+    QString line;
+
+    while (stream.readLineInto(&line))
+    {
+        QStringList fields = line.split(line.contains('\t') ? '\t' : ',');
+        if (fields.size() < 2)
+            continue;
+
+        int odds = 0;
+        if (!TeamTableModel::parseOdds(fields.last(), odds))
+            continue;
+
+        QString leagueName = fields.size() >= 3 ? fields.first().trimmed() : fallbackName;
+        QString teamName = fields.at(fields.size() - 2).trimmed();
+
+        auto found = byName.find(leagueName);
+        if (found == byName.end())
+        {
+            found = byName.insert(leagueName, leagues.size());
+            leagues.append(League{leagueName, {}});
+        }
+
+        League &league = leagues[found.value()];
+        if (teamName.isEmpty())
+            teamName = QString("Team %1").arg(league.teams.size() + 1);
+        league.teams.append(qMakePair(teamName, odds));
+    }
+
+    if (byName.isEmpty())
+    {
+        error = QString("%1: no teams with odds found").arg(fallbackName);
+        return false;
+    }
+    return true;
+}
+
+int BatchLottery::run(int threads, std::FILE *out)
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+
+    QAtomicInt failures = 0;
+
+    for (int i = 0; i < leagues.size(); ++i)
+    {
+        pool.start([this, i, out, &failures]()
+                   {
+            bool drawn = false;
+            HistoryStore::Run record;
+            QByteArray line = drawLeague(i, drawn, record);
+            if (!drawn)
+                failures.fetchAndAddRelaxed(1);
+
+            // Whole lines only, so readers never see two results interleaved
+            QMutexLocker locker(&outputMutex);
+            std::fwrite(line.constData(), 1, line.size(), out);
+            std::fflush(out);
+
+            if (drawn && history.isOpen() && !history.append(record))
+            {
+                std::fprintf(stderr, "%s\n", history.errorString().c_str());
+                failures.fetchAndAddRelaxed(1);
+            } });
+    }
+
+    pool.waitForDone();
+    return failures.loadRelaxed();
+}
+
+// Compares every recorded lottery with its odds: how often the favourite won and,
+// for each odds table, where its teams actually picked against their exact chances
+bool BatchLottery::reportHistory(const QString &path, std::FILE *out, QString &error)
+{
+    HistoryStore store;
+    if (!store.open(QFile::encodeName(path).toStdString()))
+    {
+        error = QString::fromStdString(store.errorString());
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    HistoryStore::BestOdds favourite = store.bestOddsWins();
+    std::vector<HistoryStore::PickDistribution> tables = store.pickDistributions();
+    double queryMilliseconds = timer.nsecsElapsed() / 1e6;
+
+    QJsonObject favouriteResult;
+    favouriteResult["runs"] = static_cast<qint64>(favourite.runs);
+    favouriteResult["wins"] = static_cast<qint64>(favourite.wins);
+    favouriteResult["expectedWins"] = favourite.expectedWins;
+
+    QJsonArray tableResults;
+    for (std::size_t i = 0; i < tables.size() && i < reportTables; ++i)
+    {
+        const HistoryStore::PickDistribution &table = tables[i];
+        const int picks = std::min(table.teams(), reportPicks);
+
+        // Exact odds exist for the app's own rules, the shipped formats redraw
+        ExactPickOdds exact;
+        if (table.format == HistoryStore::noName && table.teams() <= 64)
+        {
+            std::vector<std::int64_t> weights(table.odds.begin(), table.odds.end());
+            exact = table.weightedOrder ? ExactPickOdds::weightedOrder(weights, picks) : ExactPickOdds::winnerThenShuffle(weights, picks);
+        }
+
+        QJsonArray teams;
+        for (int team = 0; team < table.teams(); ++team)
+        {
+            QJsonArray observed;
+            QJsonArray expected;
+            for (int pick = 0; pick < picks; ++pick)
+            {
+                observed.append(static_cast<double>(table.counts[static_cast<std::size_t>(team) * table.teams() + pick]) / table.runs);
+                if (exact.isValid())
+                    expected.append(exact.probability(team, pick));
+            }
+
+            QJsonObject entry;
+            entry["odds"] = TeamTableModel::formatOdds(table.odds[team]);
+            entry["observed"] = observed;
+            if (exact.isValid())
+                entry["expected"] = expected;
+            teams.append(entry);
+        }
+
+        QJsonObject tableResult;
+        if (table.format != HistoryStore::noName)
+            tableResult["mode"] = QString::fromStdString(store.name(table.format));
+        else
+            tableResult["mode"] = table.weightedOrder ? "weighted-order" : "winner-then-shuffle";
+        tableResult["runs"] = static_cast<qint64>(table.runs);
+        tableResult["teams"] = teams;
+        tableResults.append(tableResult);
+    }
+
+    QJsonObject result;
+    result["history"] = path;
+    result["runs"] = static_cast<qint64>(store.runCount());
+    result["bytes"] = static_cast<qint64>(store.sizeInBytes());
+    result["favourite"] = favouriteResult;
+    result["oddsTables"] = static_cast<qint64>(tables.size());
+    result["tables"] = tableResults;
+    result["queryMilliseconds"] = queryMilliseconds;
+
+    QByteArray line = QJsonDocument(result).toJson(QJsonDocument::Compact) + '\n';
+    std::fwrite(line.constData(), 1, line.size(), out);
+    return true;
+}
+
+// Draws one league the way the window does and returns its JSON line
+QByteArray BatchLottery::drawLeague(int index, bool &drawn, HistoryStore::Run &record) const
+{
+    if (!format.isEmpty())
+        return drawFormatLeague(index, drawn, record);
+
+    const League &league = leagues[index];
+
+    qint64 total = 0;
+    std::vector<std::int64_t> weights;
+    weights.reserve(league.teams.size());
+    for (const auto &team : league.teams)
+    {
+        weights.push_back(team.second);
+        total += team.second;
+    }
+
+    // Same rule as the Do Lottery button
+    if (total != TeamTableModel::fullOdds)
+    {
+        QJsonObject failed;
+        failed["error"] = QString("odds add up to %1, not 100%").arg(TeamTableModel::formatOdds(static_cast<int>(total)));
+        failed["league"] = league.name;
+        failed["index"] = index;
+        return QJsonDocument(failed).toJson(QJsonDocument::Compact) + '\n';
+    }
+
+    // Every league draws from its own stream of the seed, so results do not depend on scheduling
+    Philox4x32 rng(seed, static_cast<std::uint64_t>(index));
+    std::vector<int> order = drawDraftOrder(weights, weightedOrder, rng);
+
+    QJsonArray picks;
+    for (std::size_t pick = 0; pick < order.size(); ++pick)
+    {
+        const auto &team = league.teams[order[pick]];
+        QJsonObject entry;
+        entry["pick"] = static_cast<int>(pick + 1);
+        entry["team"] = team.first;
+        entry["odds"] = TeamTableModel::formatOdds(team.second);
+        picks.append(entry);
+    }
+
+    // The reveal eliminates from the last pick up, so the order is reversed there
+    QJsonArray eliminations;
+    for (auto it = order.rbegin(); it + 1 < order.rend(); ++it)
+        eliminations.append(league.teams[*it].first);
+
+    QJsonObject result;
+    result["league"] = league.name;
+    result["index"] = index;
+    result["mode"] = weightedOrder ? "weighted-order" : "winner-then-shuffle";
+    result["seed"] = QString::number(seed);
+    result["winner"] = league.teams[order.front()].first;
+    result["order"] = picks;
+    result["eliminations"] = eliminations;
+    drawn = true;
+
+    std::vector<int> odds;
+    for (const auto &team : league.teams)
+        odds.push_back(team.second);
+    recordLeague(index, order, odds, record);
+    return QJsonDocument(result).toJson(QJsonDocument::Compact) + '\n';
+}
+
+// Draws one league with a shipped format, the teams listed worst record first.
+// The league's own odds are replaced by the format's published ones.
+QByteArray BatchLottery::drawFormatLeague(int index, bool &drawn, HistoryStore::Run &record) const
+{
+    const League &league = leagues[index];
+    Philox4x32 rng(seed, static_cast<std::uint64_t>(index));
+
+    // The format is looked up once per league, the draw itself is the format's own specialization
+    std::vector<int> order;
+    std::vector<int> odds;
+    int expectedTeams = 0;
+    LotteryFormats::withFormat(format.constData(), [&](auto f)
+                               {
+        using Format = decltype(f);
+        expectedTeams = static_cast<int>(Format::odds.combinations.size());
+        if (league.teams.size() != expectedTeams)
+            return;
+
+        for (std::int64_t c : Format::odds.combinations)
+            odds.push_back(static_cast<int>(c * TeamTableModel::fullOdds / Format::odds.assigned()));
+        order = LotteryFormats::lottery<Format>().draw(rng); });
+
+    if (order.empty())
+    {
+        QJsonObject failed;
+        failed["error"] = QString("the %1 format needs %2 teams, not %3").arg(QString::fromLatin1(format)).arg(expectedTeams).arg(league.teams.size());
+        failed["league"] = league.name;
+        failed["index"] = index;
+        return QJsonDocument(failed).toJson(QJsonDocument::Compact) + '\n';
+    }
+
+    QJsonArray picks;
+    for (std::size_t pick = 0; pick < order.size(); ++pick)
+    {
+        QJsonObject entry;
+        entry["pick"] = static_cast<int>(pick + 1);
+        entry["team"] = league.teams[order[pick]].first;
+        entry["odds"] = TeamTableModel::formatOdds(odds[order[pick]]);
+        entry["moved"] = order[pick] - static_cast<int>(pick);
+        picks.append(entry);
+    }
+
+    QJsonArray eliminations;
+    for (auto it = order.rbegin(); it + 1 < order.rend(); ++it)
+        eliminations.append(league.teams[*it].first);
+
+    QJsonObject result;
+    result["league"] = league.name;
+    result["index"] = index;
+    result["mode"] = QString::fromLatin1(format);
+    result["seed"] = QString::number(seed);
+    result["winner"] = league.teams[order.front()].first;
+    result["order"] = picks;
+    result["eliminations"] = eliminations;
+    drawn = true;
+
+    recordLeague(index, order, odds, record);
+    record.format = format.toStdString();
+    return QJsonDocument(result).toJson(QJsonDocument::Compact) + '\n';
+}
+
+// Fills the history record of a drawn league, the draw number is the league's stream.
+// Teams without odds take no pick, so they are left out as the window leaves them out.
+void BatchLottery::recordLeague(int index, const std::vector<int> &order, const std::vector<int> &odds, HistoryStore::Run &record) const
+{
+    const League &league = leagues[index];
+    record.timestamp = QDateTime::currentMSecsSinceEpoch();
+    record.seed = seed;
+    record.draw = static_cast<std::uint64_t>(index);
+    record.weightedOrder = weightedOrder && format.isEmpty();
+
+    std::vector<int> recorded(odds.size(), -1);
+    for (std::size_t team = 0; team < odds.size(); ++team)
+    {
+        if (odds[team] <= 0)
+            continue;
+        recorded[team] = static_cast<int>(record.names.size());
+        record.names.push_back(league.teams[static_cast<int>(team)].first.toStdString());
+        record.odds.push_back(odds[team]);
+    }
+    for (int team : order)
+        record.order.push_back(recorded[team]);
+}
+
+bool BatchLottery::setHistory(const QString &path, QString &error)
+{
+    if (history.open(QFile::encodeName(path).toStdString()))
+        return true;
+    error = QString::fromStdString(history.errorString());
+    return false;
+}
+
+bool BatchLottery::drawRaffle(const QString &path, int picks, quint64 seed, bool writeIndex, std::FILE *out, QString &error)
+{
+    // Names stay in the mapped file, only the winners are turned into QStrings
+    EntryFile entries;
+    std::string indexPath = QFile::encodeName(path + ".idx").toStdString();
+    if (!entries.open(QFile::encodeName(path).toStdString(), indexPath))
+    {
+        error = QString::fromStdString(entries.errorString());
+        return false;
+    }
+
+    if (writeIndex && !entries.loadedFromIndex() && !entries.writeIndex(indexPath))
+    {
+        error = QString("Could not write %1.idx").arg(path);
+        return false;
+    }
+
+    // Drawn from the weights where they lie, so memory stays close to the file's size
+    Philox4x32 rng(seed);
+    std::vector<int> order;
+    if (WeightedOrderSampler::drawTop(entries.weightData(), entries.size(), static_cast<std::size_t>(std::max(1, picks)), rng, order) == 0)
+    {
+        error = QString("%1: no entries with a positive weight").arg(path);
+        return false;
+    }
+
+    QJsonArray winners;
+    for (std::size_t pick = 0; pick < order.size(); ++pick)
+    {
+        std::string_view name = entries.name(order[pick]);
+        QJsonObject entry;
+        entry["pick"] = static_cast<int>(pick + 1);
+        entry["entry"] = order[pick];
+        entry["name"] = QString::fromUtf8(name.data(), static_cast<int>(name.size()));
+        entry["weight"] = static_cast<qint64>(entries.weight(order[pick]));
+        winners.append(entry);
+    }
+
+    QJsonObject result;
+    result["raffle"] = path;
+    result["entries"] = static_cast<qint64>(entries.size());
+    result["skipped"] = static_cast<qint64>(entries.skippedLines());
+    result["seed"] = QString::number(seed);
+    result["winners"] = winners;
+
+    QByteArray line = QJsonDocument(result).toJson(QJsonDocument::Compact) + '\n';
+    std::fwrite(line.constData(), 1, line.size(), out);
+    return true;
+}
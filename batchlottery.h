@@ -0,0 +1,73 @@
+#ifndef BATCHLOTTERY_H
+#define BATCHLOTTERY_H
+
+#include "historystore.h"
+
+#include <QByteArray>
+#include <QJsonValue>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+#include <cstdio>
+
+// Runs many leagues' lotteries without a window, for the --batch command line.
+// Leagues come from JSON or CSV files (or stdin), each one is drawn on a
+// thread pool worker with the same rules as the GUI, and every result is
+// written as one JSON line as soon as it is ready.
+class BatchLottery
+{
+public:
+    struct League
+    {
+        QString name;
+        QVector<QPair<QString, int>> teams;
+    };
+
+    // A non-empty `format` draws every league with that format's rules and odds, see LotteryFormats
+    BatchLottery(quint64 seed, bool weightedOrder, const QString &format = QString());
+
+    // Whether `format` names one of the shipped lottery formats
+    static bool isFormat(const QString &format);
+
+    // Reads leagues from a file, "-" reads stdin. Returns false with a message on a bad file.
+    bool load(const QString &path, QString &error);
+
+    int leagueCount() const { return leagues.size(); }
+    const League &league(int index) const { return leagues[index]; }
+
+    // Draws `picks` winners from a large "name,weight" entry file, writing an
+    // index next to it for the next run when `writeIndex` is set. Returns false with a message on failure.
+    static bool drawRaffle(const QString &path, int picks, quint64 seed, bool writeIndex, std::FILE *out, QString &error);
+
+    // Records every league drawn by run() in the history log at `path`
+    bool setHistory(const QString &path, QString &error);
+
+    // Writes how the recorded lotteries compare to their odds as one JSON line
+    static bool reportHistory(const QString &path, std::FILE *out, QString &error);
+
+    // Draws every loaded league on `threads` workers (0 uses every core) and
+    // writes the results to `out`. Returns the number of leagues that failed.
+    int run(int threads, std::FILE *out);
+
+private:
+    bool loadJson(const QByteArray &data, const QString &fallbackName, QString &error);
+    bool loadCsv(const QByteArray &data, const QString &fallbackName, QString &error);
+    bool addLeague(const QJsonValue &value, const QString &fallbackName, QString &error);
+
+    QByteArray drawLeague(int index, bool &drawn, HistoryStore::Run &record) const;
+    QByteArray drawFormatLeague(int index, bool &drawn, HistoryStore::Run &record) const;
+    void recordLeague(int index, const std::vector<int> &order, const std::vector<int> &odds, HistoryStore::Run &record) const;
+
+    QVector<League> leagues;
+    quint64 seed;
+    bool weightedOrder;
+    QByteArray format;
+
+    // Written under outputMutex
+    QMutex outputMutex;
+    HistoryStore history;
+};
+
+#endif // BATCHLOTTERY_H
@@ -0,0 +1,17 @@
+TARGET = draftlottery-bench
+QT      = core gui widgets
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+QMAKE_CXXFLAGS_RELEASE += -O3
+CONFIG += optimize_full
+
+# Benchmarks the same window and engine code the app ships
+include(../draftlottery.pri)
+
+SOURCES += \
+    benchmarkrunner.cpp \
+    main.cpp
+
+HEADERS += \
+    benchmarkrunner.h
@@ -0,0 +1,145 @@
+#include "benchmarkrunner.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+BenchmarkRunner::BenchmarkRunner(int repetitions, const QString &filter)
+    : repetitions(std::max(1, repetitions)), filter(filter)
+{
+}
+
+bool BenchmarkRunner::wants(const QStringList &names) const
+{
+    if (filter.isEmpty())
+        return true;
+
+    for (const QString &name : names)
+    {
+        if (name.contains(filter))
+            return true;
+    }
+    return false;
+}
+
+void BenchmarkRunner::run(const QString &name, qint64 operations, const std::function<void(qint64)> &body)
+{
+    if (!wants({name}))
+        return;
+
+    Result result;
+    result.name = name;
+    result.operations = operations;
+
+    // Warm caches and lazy initialization before measuring
+    body(operations);
+
+    QElapsedTimer timer;
+    for (int i = 0; i < repetitions; ++i)
+    {
+        timer.start();
+        body(operations);
+        result.samples.append(static_cast<double>(timer.nsecsElapsed()) / operations);
+    }
+
+    // Progress goes to stderr so stdout stays machine readable
+    std::fprintf(stderr, "%-40s median %12.1f ns/op\n", qPrintable(name), result.median());
+    completed.append(result);
+}
+
+double BenchmarkRunner::Result::min() const
+{
+    return *std::min_element(samples.begin(), samples.end());
+}
+
+double BenchmarkRunner::Result::max() const
+{
+    return *std::max_element(samples.begin(), samples.end());
+}
+
+double BenchmarkRunner::Result::mean() const
+{
+    double sum = 0.0;
+    for (double sample : samples)
+        sum += sample;
+    return sum / samples.size();
+}
+
+double BenchmarkRunner::Result::median() const
+{
+    return percentile(0.5);
+}
+
+// Sample standard deviation
+double BenchmarkRunner::Result::stddev() const
+{
+    if (samples.size() < 2)
+        return 0.0;
+
+    double average = mean();
+    double sum = 0.0;
+    for (double sample : samples)
+        sum += (sample - average) * (sample - average);
+    return std::sqrt(sum / (samples.size() - 1));
+}
+
+// Linear interpolation between the closest ranks
+double BenchmarkRunner::Result::percentile(double p) const
+{
+    QVector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    double rank = p * (sorted.size() - 1);
+    int lower = static_cast<int>(std::floor(rank));
+    int upper = std::min(lower + 1, static_cast<int>(sorted.size()) - 1);
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - lower);
+}
+
+QByteArray BenchmarkRunner::toJson() const
+{
+    QJsonArray benchmarks;
+    for (const Result &result : completed)
+    {
+        QJsonArray samples;
+        for (double sample : result.samples)
+            samples.append(sample);
+
+        QJsonObject entry;
+        entry["name"] = result.name;
+        entry["unit"] = "ns/op";
+        entry["operations"] = result.operations;
+        entry["repetitions"] = samples;
+        entry["min"] = result.min();
+        entry["median"] = result.median();
+        entry["mean"] = result.mean();
+        entry["stddev"] = result.stddev();
+        entry["p95"] = result.percentile(0.95);
+        entry["max"] = result.max();
+        benchmarks.append(entry);
+    }
+
+    QJsonObject root;
+    root["benchmarks"] = benchmarks;
+    return QJsonDocument(root).toJson();
+}
+
+QByteArray BenchmarkRunner::toCsv() const
+{
+    QByteArray csv;
+    QTextStream out(&csv);
+    out << "name,unit,operations,repetitions,min,median,mean,stddev,p95,max\n";
+    for (const Result &result : completed)
+    {
+        out << result.name << ",ns/op," << result.operations << "," << result.samples.size() << ","
+            << result.min() << "," << result.median() << "," << result.mean() << ","
+            << result.stddev() << "," << result.percentile(0.95) << "," << result.max() << "\n";
+    }
+    out.flush();
+    return csv;
+}
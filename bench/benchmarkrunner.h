@@ -0,0 +1,59 @@
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+// Times named cases over several repetitions and summarizes them.
+// Each repetition runs the case body for a fixed number of operations and
+// records the mean nanoseconds per operation, one warm-up repetition is
+// discarded first.
+class BenchmarkRunner
+{
+public:
+    struct Result
+    {
+        QString name;
+        qint64 operations = 0;
+        QVector<double> samples;
+
+        double min() const;
+        double max() const;
+        double mean() const;
+        double median() const;
+        double stddev() const;
+        double percentile(double p) const;
+    };
+
+    BenchmarkRunner(int repetitions, const QString &filter);
+
+    // Whether the filter lets any of these cases run, so a group can skip its setup
+    bool wants(const QStringList &names) const;
+
+    // body(operations) must perform `operations` units of work
+    void run(const QString &name, qint64 operations, const std::function<void(qint64)> &body);
+
+    const QVector<Result> &results() const { return completed; }
+
+    QByteArray toJson() const;
+    QByteArray toCsv() const;
+
+private:
+    int repetitions;
+    QString filter;
+    QVector<Result> completed;
+};
+
+// Keeps the compiler from discarding work whose result is otherwise unused
+template <typename T>
+inline void keepAlive(T value)
+{
+    static volatile T sink;
+    sink = value;
+}
+
+#endif // BENCHMARKRUNNER_H
@@ -0,0 +1,594 @@
+#include "benchmarkrunner.h"
+#include "cardrenderer.h"
+#include "confettioverlay.h"
+#include "confettisystem.h"
+#include "draftorder.h"
+#include "dynamicsampler.h"
+#include "entryfile.h"
+#include "historystore.h"
+#include "lotteryengine.h"
+#include "lotteryrules.h"
+#include "mainwindow.h"
+#include "philox.h"
+#include "revealtimeline.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDoubleSpinBox>
+#include <QFile>
+#include <QImage>
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// Odds that add up to 100 like a real league, the last team takes the remainder
+static QVector<int> leagueOdds(int teams)
+{
+    QVector<int> odds;
+    int remaining = 100;
+    for (int i = 0; i < teams - 1; ++i)
+    {
+        int share = std::max(1, remaining / (teams - i) + (i % 3) - 1);
+        odds.append(share);
+        remaining -= share;
+    }
+    odds.append(std::max(1, remaining));
+    return odds;
+}
+
+// The cumulative sum and linear scan the window used before the alias table
+static void benchmarkDraws(BenchmarkRunner &runner)
+{
+    for (int teams : {12, 1000})
+    {
+        if (!runner.wants({QString("draw/linear-scan/%1").arg(teams), QString("draw/alias/%1").arg(teams), QString("draw/alias-batch/%1").arg(teams)}))
+            continue;
+
+        QVector<int> odds = leagueOdds(teams);
+        std::vector<std::int64_t> weights(odds.begin(), odds.end());
+        LotteryEngine engine(weights);
+
+        runner.run(QString("draw/linear-scan/%1").arg(teams), 1000000, [&odds](qint64 operations)
+                   {
+            for (qint64 op = 0; op < operations; ++op)
+            {
+                int totalOdds = 0;
+                for (int value : odds)
+                    totalOdds += value;
+
+                int randomValue = QRandomGenerator::global()->bounded(totalOdds);
+                int cumulativeOdds = 0;
+                int winnerIndex = -1;
+                for (int i = 0; i < odds.size(); ++i)
+                {
+                    cumulativeOdds += odds[i];
+                    if (randomValue < cumulativeOdds)
+                    {
+                        winnerIndex = i;
+                        break;
+                    }
+                }
+                keepAlive(winnerIndex);
+            } });
+
+        runner.run(QString("draw/alias/%1").arg(teams), 1000000, [&engine](qint64 operations)
+                   {
+            for (qint64 op = 0; op < operations; ++op)
+                keepAlive(engine.draw(*QRandomGenerator::global())); });
+
+        std::vector<int> buffer(1000000);
+        runner.run(QString("draw/alias-batch/%1").arg(teams), static_cast<qint64>(buffer.size()), [&engine, &buffer](qint64 operations)
+                   {
+            std::mt19937_64 rng(42);
+            engine.drawBatch(buffer.data(), static_cast<std::size_t>(operations), rng);
+            keepAlive(buffer[0]); });
+    }
+}
+
+// A rolling raffle with 10M entries, one operation is one re-weight and one draw
+static void benchmarkDynamic(BenchmarkRunner &runner)
+{
+    const int entries = 10000000;
+    if (!runner.wants({QString("dynamic/cumulative-scan/%1").arg(entries), QString("dynamic/mixed/%1").arg(entries),
+                       QString("dynamic/mixed-batch/%1").arg(entries), QString("dynamic/rebuild/%1").arg(entries)}))
+        return;
+
+    std::vector<std::int64_t> weights(entries);
+    for (int i = 0; i < entries; ++i)
+        weights[i] = 1 + i % 50;
+
+    // The cumulative sum rebuilt for every draw, as the window did
+    runner.run(QString("dynamic/cumulative-scan/%1").arg(entries), 3, [&weights](qint64 operations)
+               {
+        Philox4x32 rng(42);
+        std::vector<std::uint64_t> cumulative(weights.size());
+        for (qint64 op = 0; op < operations; ++op)
+        {
+            weights[uniformBelow(rng, weights.size())] = 1 + static_cast<std::int64_t>(uniformBelow(rng, 50));
+            std::uint64_t sum = 0;
+            for (std::size_t i = 0; i < weights.size(); ++i)
+                cumulative[i] = sum += static_cast<std::uint64_t>(weights[i]);
+            std::uint64_t target = uniformBelow(rng, sum);
+            keepAlive(std::upper_bound(cumulative.begin(), cumulative.end(), target) - cumulative.begin());
+        } });
+
+    DynamicSampler sampler(weights);
+
+    runner.run(QString("dynamic/mixed/%1").arg(entries), 1000000, [&sampler, entries](qint64 operations)
+               {
+        Philox4x32 rng(42);
+        for (qint64 op = 0; op < operations; ++op)
+        {
+            sampler.setWeight(static_cast<int>(uniformBelow(rng, entries)), 1 + static_cast<std::int64_t>(uniformBelow(rng, 50)));
+            keepAlive(sampler.draw(rng));
+        } });
+
+    // Entries joining and leaving in bursts, each burst followed by a batch of draws
+    const std::size_t burst = 4096;
+    std::vector<DynamicSampler::Update> updates(burst);
+    std::vector<int> winners(burst);
+    runner.run(QString("dynamic/mixed-batch/%1").arg(entries), 1000000, [&sampler, &updates, &winners, entries](qint64 operations)
+               {
+        Philox4x32 rng(42);
+        for (qint64 done = 0; done < operations; done += static_cast<qint64>(updates.size()))
+        {
+            for (DynamicSampler::Update &u : updates)
+                u = {static_cast<int>(uniformBelow(rng, entries)), static_cast<std::int64_t>(uniformBelow(rng, 51))};
+            sampler.update(updates);
+            sampler.drawBatch(winners.data(), winners.size(), rng);
+        }
+        keepAlive(winners[0]); });
+
+    runner.run(QString("dynamic/rebuild/%1").arg(entries), entries, [&sampler, &weights](qint64)
+               {
+        sampler.assign(weights);
+        keepAlive(sampler.totalWeight()); });
+}
+
+// Full lotteries in each shipped format, one operation is one complete draft order.
+// Each format is first checked against the league's published first-pick odds, in percent.
+static bool benchmarkRules(BenchmarkRunner &runner)
+{
+    bool passed = true;
+    auto run = [&runner, &passed](auto format, const std::vector<double> &firstPick)
+    {
+        using Format = decltype(format);
+        if (!runner.wants({QString("rules/%1").arg(Format::name)}))
+            return;
+
+        typename Format::Lottery lottery = LotteryFormats::lottery<Format>();
+
+        // 2M lotteries put the odds within about 0.03 points, 0.2 leaves room without hiding a rule error
+        PickOddsResult odds = lottery.simulate(2000000, 0, 42);
+        for (int team = 0; team < lottery.teamCount(); ++team)
+        {
+            double observed = odds.probability(team, 0) * 100.0;
+            if (std::abs(observed - firstPick[static_cast<std::size_t>(team)]) > 0.2)
+            {
+                std::fprintf(stderr, "%s: team %d wins the first pick %.2f%% of the time, the league publishes %.1f%%\n", Format::name,
+                             team + 1, observed, firstPick[static_cast<std::size_t>(team)]);
+                passed = false;
+            }
+        }
+
+        runner.run(QString("rules/%1").arg(Format::name), 1000000, [&lottery](qint64 operations)
+                   {
+            Philox4x32 rng(42);
+            std::array<int, Format::Lottery::maxTeams> order;
+            for (qint64 op = 0; op < operations; ++op)
+                lottery.draw(rng, order.data());
+            keepAlive(order[0]); });
+    };
+
+    run(LotteryFormats::Nba2019(), {14.0, 14.0, 14.0, 12.5, 10.5, 9.0, 7.5, 6.0, 4.5, 3.0, 2.0, 1.5, 1.0, 0.5});
+    run(LotteryFormats::Nba1994(), {25.0, 19.9, 15.6, 11.9, 8.8, 6.3, 4.3, 2.8, 1.7, 1.1, 0.8, 0.7, 0.6, 0.5});
+    // Teams 12 to 16 can't move up to first, their 7% goes to the last place team
+    run(LotteryFormats::Nhl2021(), {25.5, 13.5, 11.5, 9.5, 8.5, 7.5, 6.5, 6.0, 5.0, 3.5, 3.0, 0.0, 0.0, 0.0, 0.0, 0.0});
+    return passed;
+}
+
+// Raw generator throughput, one operation is one 64-bit value
+static void benchmarkRandom(BenchmarkRunner &runner)
+{
+    const qint64 values = 1 << 22;
+    if (!runner.wants({"random/mt19937_64", "random/philox", "random/philox-block"}))
+        return;
+
+    std::vector<std::uint64_t> buffer(static_cast<std::size_t>(values));
+
+    runner.run("random/mt19937_64", values, [](qint64 operations)
+               {
+        std::mt19937_64 rng(42);
+        std::uint64_t sum = 0;
+        for (qint64 op = 0; op < operations; ++op)
+            sum += rng();
+        keepAlive(sum); });
+
+    runner.run("random/philox", values, [](qint64 operations)
+               {
+        Philox4x32 rng(42);
+        std::uint64_t sum = 0;
+        for (qint64 op = 0; op < operations; ++op)
+            sum += rng();
+        keepAlive(sum); });
+
+    runner.run("random/philox-block", values, [&buffer](qint64 operations)
+               {
+        Philox4x32 rng(42);
+        rng.generate(buffer.data(), static_cast<std::size_t>(operations));
+        keepAlive(buffer[0]); });
+}
+
+// The elimination order shuffle from startEliminationSequence, including its per-call seeding
+static void benchmarkShuffle(BenchmarkRunner &runner)
+{
+    for (int teams : {12, 500})
+    {
+        if (!runner.wants({QString("shuffle/elimination/%1").arg(teams)}))
+            continue;
+
+        QVector<QPair<QString, int>> base;
+        QVector<int> odds = leagueOdds(teams);
+        for (int i = 0; i < teams; ++i)
+            base.append(qMakePair(QString("Team %1").arg(i + 1), odds[i]));
+
+        runner.run(QString("shuffle/elimination/%1").arg(teams), 10000, [&base](qint64 operations)
+                   {
+            for (qint64 op = 0; op < operations; ++op)
+            {
+                QVector<QPair<QString, int>> teamsToEliminate = base;
+
+                std::random_device rd;
+                QRandomGenerator rng(rd());
+                for (int i = teamsToEliminate.size() - 1; i > 0; --i)
+                {
+                    int j = rng.bounded(i + 1);
+                    teamsToEliminate.swapItemsAt(i, j);
+                }
+                keepAlive(teamsToEliminate.first().second);
+            } });
+    }
+}
+
+static void benchmarkConfetti(BenchmarkRunner &runner)
+{
+    for (int particles : {150, 5000, 50000})
+    {
+        if (!runner.wants({QString("confetti/update/%1").arg(particles), QString("confetti/paint/%1").arg(particles)}))
+            continue;
+
+        ConfettiSystem system(particles, 7);
+        system.setBounds(1024, 768);
+        system.burst(512, 256, particles);
+        system.setEmitter(512, 256, true);
+
+        // One operation is one 16 ms frame for the whole system
+        runner.run(QString("confetti/update/%1").arg(particles), 600, [&system](qint64 operations)
+                   {
+            for (qint64 op = 0; op < operations; ++op)
+                system.update();
+            keepAlive(system.size()); });
+
+        // A full-screen paint pass, the worst case for the dirty-region overlay
+        ConfettiOverlay overlay(&system);
+        overlay.resize(1024, 768);
+        QImage frame(1024, 768, QImage::Format_ARGB32_Premultiplied);
+
+        runner.run(QString("confetti/paint/%1").arg(particles), 60, [&overlay, &frame](qint64 operations)
+                   {
+            for (qint64 op = 0; op < operations; ++op)
+            {
+                frame.fill(Qt::transparent);
+                QPainter painter(&frame);
+                painter.setRenderHint(QPainter::SmoothPixmapTransform);
+                overlay.paintParticles(painter, frame.rect());
+            } });
+    }
+
+    // The same scene on a 4K full-screen window, sprites rasterized at 2160 / 768
+    if (!runner.wants({"confetti/paint-4k/5000"}))
+        return;
+
+    ConfettiSystem system(5000, 7);
+    system.setBounds(3840 * 768 / 2160, 768);
+    system.burst(683, 256, 5000);
+    system.setEmitter(683, 256, true);
+    for (int step = 0; step < 60; ++step)
+        system.update();
+
+    ConfettiOverlay overlay(&system);
+    overlay.resize(3840, 2160);
+    overlay.setSceneScale(2160 / 768.0);
+    QImage frame(3840, 2160, QImage::Format_ARGB32_Premultiplied);
+
+    runner.run("confetti/paint-4k/5000", 20, [&overlay, &frame](qint64 operations)
+               {
+        for (qint64 op = 0; op < operations; ++op)
+        {
+            frame.fill(Qt::transparent);
+            QPainter painter(&frame);
+            painter.setRenderHint(QPainter::SmoothPixmapTransform);
+            overlay.paintParticles(painter, frame.rect());
+        } });
+}
+
+// A full 32-team reveal on the virtual clock, checked to the millisecond before
+// it is timed. One operation is one 16 ms frame.
+static bool benchmarkReveal(BenchmarkRunner &runner)
+{
+    if (!runner.wants({"reveal/virtual-clock/32"}))
+        return true;
+
+    RevealTimeline timeline;
+    timeline.setEliminations(31);
+    const QVector<RevealTimeline::Step> &schedule = timeline.schedule();
+    bool passed = true;
+
+    // The steps have to follow each other without gaps or overlaps
+    for (int i = 1; i < schedule.size(); ++i)
+    {
+        if (schedule[i].start != schedule[i - 1].start + schedule[i - 1].duration)
+        {
+            std::fprintf(stderr, "reveal step %d starts at %lld ms, the step before ends at %lld ms\n", i,
+                         static_cast<long long>(schedule[i].start), static_cast<long long>(schedule[i - 1].start + schedule[i - 1].duration));
+            passed = false;
+        }
+    }
+
+    int started = 0;
+    int late = 0;
+    bool finished = false;
+    QMetaObject::Connection counter = QObject::connect(&timeline, &RevealTimeline::stepStarted, [&](const RevealTimeline::Step &step)
+                                                       {
+        if (started >= schedule.size() || step.start != schedule[started].start || timeline.elapsed() != step.start)
+            ++late;
+        ++started; });
+    QObject::connect(&timeline, &RevealTimeline::finished, [&finished]()
+                     { finished = true; });
+
+    // Millisecond steps: every step has to start exactly once, on the millisecond it is scheduled for
+    timeline.start(RevealTimeline::Clock::Virtual);
+    while (timeline.isRunning())
+        timeline.advance(1);
+    if (started != schedule.size() || late > 0 || !finished || timeline.elapsed() != timeline.totalDuration())
+    {
+        std::fprintf(stderr, "reveal timeline started %d of %d steps, %d off schedule, finished at %lld of %lld ms\n", started,
+                     static_cast<int>(schedule.size()), late, static_cast<long long>(timeline.elapsed()), static_cast<long long>(timeline.totalDuration()));
+        passed = false;
+    }
+
+    // 16 ms frames: each step still starts once and the reveal ends on the first frame past its end
+    started = 0;
+    late = 0;
+    finished = false;
+    timeline.start(RevealTimeline::Clock::Virtual);
+    qint64 frames = 0;
+    while (timeline.isRunning())
+    {
+        timeline.advance(16);
+        ++frames;
+    }
+    if (started != schedule.size() || !finished || frames != (timeline.totalDuration() + 15) / 16)
+    {
+        std::fprintf(stderr, "reveal timeline started %d of %d steps in %lld frames\n", started, static_cast<int>(schedule.size()),
+                     static_cast<long long>(frames));
+        passed = false;
+    }
+    QObject::disconnect(counter);
+
+    runner.run("reveal/virtual-clock/32", frames, [&timeline](qint64 operations)
+               {
+        for (qint64 op = 0; op < operations; ++op)
+        {
+            if (!timeline.isRunning())
+                timeline.start(RevealTimeline::Clock::Virtual);
+            timeline.advance(16);
+        }
+        keepAlive(timeline.elapsed()); });
+    return passed;
+}
+
+static void benchmarkCards(BenchmarkRunner &runner)
+{
+    if (!runner.wants({"cards/elimination", "cards/winner", "cards/elimination-4k"}))
+        return;
+
+    CardRenderer renderer;
+    renderer.warmUp();
+
+    runner.run("cards/elimination", 200, [&renderer](qint64 operations)
+               {
+        for (qint64 op = 0; op < operations; ++op)
+            keepAlive(renderer.eliminationCard(QString("Team %1").arg(op % 32), 850).width()); });
+
+    runner.run("cards/winner", 50, [&renderer](qint64 operations)
+               {
+        for (qint64 op = 0; op < operations; ++op)
+            keepAlive(renderer.winnerCard(QString("Team %1").arg(op % 32), 2500).width()); });
+
+    // A 4K window renders each card at 2160 / 768 of its nominal size
+    renderer.setScale(2160 / 768.0);
+    runner.run("cards/elimination-4k", 100, [&renderer](qint64 operations)
+               {
+        for (qint64 op = 0; op < operations; ++op)
+            keepAlive(renderer.eliminationCard(QString("Team %1").arg(op % 32), 850).width()); });
+}
+
+// Queries a million recorded 14 team lotteries in place, one operation is one run
+static void benchmarkHistory(BenchmarkRunner &runner)
+{
+    const int runs = 1000000;
+    if (!runner.wants({QString("history/best-odds/%1").arg(runs), QString("history/pick-distribution/%1").arg(runs), QString("history/open/%1").arg(runs)}))
+        return;
+
+    const std::vector<std::int64_t> weights = {1400, 1400, 1400, 1250, 1050, 900, 750, 600, 450, 300, 200, 150, 100, 50};
+
+    QTemporaryDir dir;
+    HistoryStore store;
+    if (!dir.isValid() || !store.open(QFile::encodeName(dir.filePath("history.dlh")).toStdString()))
+    {
+        std::fprintf(stderr, "could not write the history log, skipping history benchmarks\n");
+        return;
+    }
+
+    HistoryStore::Run run;
+    for (std::size_t team = 0; team < weights.size(); ++team)
+    {
+        run.names.push_back("Team " + std::to_string(team + 1));
+        run.odds.push_back(static_cast<std::int32_t>(weights[team]));
+    }
+    for (int i = 0; i < runs; ++i)
+    {
+        Philox4x32 rng(7, static_cast<std::uint64_t>(i));
+        run.draw = static_cast<std::uint64_t>(i);
+        run.weightedOrder = i % 2 == 1;
+        run.order = drawDraftOrder(weights, run.weightedOrder, rng);
+        store.append(run);
+    }
+
+    runner.run(QString("history/best-odds/%1").arg(runs), runs, [&store](qint64)
+               { keepAlive(store.bestOddsWins().wins); });
+
+    runner.run(QString("history/pick-distribution/%1").arg(runs), runs, [&store](qint64)
+               { keepAlive(store.pickDistributions().size()); });
+
+    runner.run(QString("history/open/%1").arg(runs), runs, [&dir](qint64)
+               {
+        HistoryStore reopened;
+        reopened.open(QFile::encodeName(dir.filePath("history.dlh")).toStdString());
+        keepAlive(reopened.runCount()); });
+}
+
+// Loads a raffle entry file by parsing it and then through its binary index
+static void benchmarkEntryFile(BenchmarkRunner &runner)
+{
+    const int entries = 2000000;
+    if (!runner.wants({QString("entries/parse/%1").arg(entries), QString("entries/index/%1").arg(entries)}))
+        return;
+
+    QTemporaryDir dir;
+    QString path = dir.filePath("entries.csv");
+    std::string indexPath = QFile::encodeName(dir.filePath("entries.csv.idx")).toStdString();
+
+    QFile file(path);
+    if (!dir.isValid() || !file.open(QIODevice::WriteOnly))
+    {
+        std::fprintf(stderr, "could not write the entry file, skipping entry file benchmarks\n");
+        return;
+    }
+    for (int i = 0; i < entries; ++i)
+        file.write(QString("Entrant %1,%2\n").arg(i).arg(1 + i % 50).toUtf8());
+    file.close();
+
+    std::string source = QFile::encodeName(path).toStdString();
+
+    runner.run(QString("entries/parse/%1").arg(entries), entries, [&source](qint64)
+               {
+        EntryFile loaded;
+        loaded.open(source);
+        keepAlive(loaded.size()); });
+
+    EntryFile parsed;
+    parsed.open(source);
+    parsed.writeIndex(indexPath);
+
+    runner.run(QString("entries/index/%1").arg(entries), entries, [&source, &indexPath](qint64)
+               {
+        EntryFile loaded;
+        loaded.open(source, indexPath);
+        keepAlive(loaded.size()); });
+}
+
+// Grows the team list from 1 to 500 rows and back, through the same spin box the user drives
+static void benchmarkTeamInputs(BenchmarkRunner &runner)
+{
+    if (!runner.wants({"inputs/rebuild/1-500-1"}))
+        return;
+
+    MainWindow window;
+    window.show();
+
+    QDoubleSpinBox *teamCount = window.findChild<QDoubleSpinBox *>("dsbTeamCount");
+    if (!teamCount)
+    {
+        std::fprintf(stderr, "team count spin box not found, skipping input benchmarks\n");
+        return;
+    }
+
+    teamCount->setMinimum(1);
+    teamCount->setMaximum(500);
+
+    runner.run("inputs/rebuild/1-500-1", 5, [teamCount](qint64 operations)
+               {
+        for (qint64 op = 0; op < operations; ++op)
+        {
+            teamCount->setValue(500);
+            QCoreApplication::processEvents();
+            teamCount->setValue(1);
+            QCoreApplication::processEvents();
+        } });
+}
+
+int main(int argc, char *argv[])
+{
+    // Runs headless unless a platform was chosen explicitly
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName("draftlottery-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks the random generators, draw, lottery formats, dynamic sampler, shuffle, confetti, reveal timeline, card rendering, entry file and team input hot paths.");
+    parser.addHelpOption();
+    parser.addOption({"repetitions", "Measured repetitions per case.", "count", "10"});
+    parser.addOption({"filter", "Only run cases whose name contains this text.", "text"});
+    parser.addOption({"format", "Output format, json or csv.", "format", "json"});
+    parser.addOption({"output", "Write results to this file instead of stdout.", "file"});
+    parser.process(app);
+
+    BenchmarkRunner runner(parser.value("repetitions").toInt(), parser.value("filter"));
+
+    benchmarkRandom(runner);
+    benchmarkDraws(runner);
+    bool checksPassed = benchmarkRules(runner);
+    benchmarkDynamic(runner);
+    benchmarkShuffle(runner);
+    benchmarkConfetti(runner);
+    checksPassed = benchmarkReveal(runner) && checksPassed;
+    benchmarkCards(runner);
+    benchmarkEntryFile(runner);
+    benchmarkHistory(runner);
+    benchmarkTeamInputs(runner);
+
+    QByteArray report = parser.value("format") == "csv" ? runner.toCsv() : runner.toJson();
+
+    if (parser.isSet("output"))
+    {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            std::fprintf(stderr, "could not write %s\n", qPrintable(parser.value("output")));
+            return 1;
+        }
+        file.write(report);
+    }
+    else
+    {
+        std::fwrite(report.constData(), 1, report.size(), stdout);
+    }
+
+    // Cases that also check their results fail the run, so CI catches them. A filter skips the checks of the cases it leaves out.
+    if (!checksPassed)
+    {
+        std::fprintf(stderr, "correctness checks failed\n");
+        return 1;
+    }
+    return 0;
+}
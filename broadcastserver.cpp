@@ -0,0 +1,433 @@
+#include "broadcastserver.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QJsonDocument>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QtEndian>
+
+#include <deque>
+
+namespace
+{
+    // Bytes handed to a socket before the rest waits in the viewer's queue
+    const qint64 socketHighWater = 64 * 1024;
+
+    // A viewer with this much queued has stopped reading and is disconnected
+    const qint64 maxPendingBytes = 1024 * 1024;
+
+    const int maxRequestBytes = 8 * 1024;
+    const quint64 maxViewerPayload = 4 * 1024;
+
+    // Events kept for viewers joining mid-reveal, a reveal has one per team plus a few
+    const int maxHistory = 1024;
+
+    const QByteArray webSocketGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+    enum Opcode
+    {
+        TextOpcode = 0x1,
+        CloseOpcode = 0x8,
+        PingOpcode = 0x9,
+        PongOpcode = 0xA
+    };
+
+    QByteArray frame(int opcode, const QByteArray &payload)
+    {
+        QByteArray header;
+        header.append(static_cast<char>(0x80 | opcode));
+        if (payload.size() < 126)
+        {
+            header.append(static_cast<char>(payload.size()));
+        }
+        else if (payload.size() < 65536)
+        {
+            header.append(static_cast<char>(126));
+            header.append(static_cast<char>(payload.size() >> 8));
+            header.append(static_cast<char>(payload.size() & 0xff));
+        }
+        else
+        {
+            header.append(static_cast<char>(127));
+            for (int shift = 56; shift >= 0; shift -= 8)
+                header.append(static_cast<char>((static_cast<quint64>(payload.size()) >> shift) & 0xff));
+        }
+        return header + payload;
+    }
+
+    QByteArray httpResponse(const QByteArray &status, const QByteArray &type, const QByteArray &body)
+    {
+        return "HTTP/1.1 " + status + "\r\nContent-Type: " + type + "\r\nContent-Length: " + QByteArray::number(body.size()) +
+               "\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n" + body;
+    }
+}
+
+// Owns the listening socket and every viewer, lives on the server thread
+class BroadcastHub : public QObject
+{
+public:
+    explicit BroadcastHub(BroadcastServer *owner);
+
+    bool listen(quint16 port, QString &error);
+    void shutdown();
+
+    // Queues one encoded frame for every viewer, `restart` forgets the previous reveal
+    void broadcast(const QByteArray &frame, bool restart);
+
+private:
+    struct Viewer
+    {
+        QByteArray request;  // HTTP request head until it is complete
+        QByteArray incoming; // Unparsed WebSocket frames from the viewer
+        bool upgraded = false;
+
+        // Frames shared with every other viewer, waiting for room in the socket
+        std::deque<QByteArray> pending;
+        qint64 pendingBytes = 0;
+    };
+
+    void accept();
+    void read(QTcpSocket *socket);
+    bool readRequest(QTcpSocket *socket, Viewer &viewer);
+    bool readFrames(QTcpSocket *socket, Viewer &viewer);
+    bool enqueue(QTcpSocket *socket, Viewer &viewer, const QByteArray &data);
+    void drain(QTcpSocket *socket);
+    void drop(QTcpSocket *socket);
+
+    BroadcastServer *owner;
+    QTcpServer *server;
+    QHash<QTcpSocket *, Viewer> viewers;
+    QVector<QByteArray> history;
+    QByteArray viewerPage;
+};
+
+BroadcastHub::BroadcastHub(BroadcastServer *owner)
+    : owner(owner), server(nullptr)
+{
+    QFile page(":/resources/viewer.html");
+    if (page.open(QIODevice::ReadOnly))
+        viewerPage = page.readAll();
+}
+
+bool BroadcastHub::listen(quint16 port, QString &error)
+{
+    server = new QTcpServer(this);
+    server->setMaxPendingConnections(256);
+    connect(server, &QTcpServer::newConnection, this, [this]()
+            { accept(); });
+
+    if (!server->listen(QHostAddress::Any, port))
+    {
+        error = server->errorString();
+        delete server;
+        server = nullptr;
+        return false;
+    }
+
+    owner->listeningPort = server->serverPort();
+    return true;
+}
+
+void BroadcastHub::shutdown()
+{
+    for (auto it = viewers.begin(); it != viewers.end(); ++it)
+    {
+        it.key()->disconnect(this);
+        it.key()->abort();
+        delete it.key();
+    }
+    viewers.clear();
+    history.clear();
+
+    // Also deletes the sockets already dropped and waiting for deleteLater, they are its children
+    delete server;
+    server = nullptr;
+
+    owner->clients.storeRelaxed(0);
+    emit owner->clientCountChanged(0);
+}
+
+void BroadcastHub::accept()
+{
+    while (QTcpSocket *socket = server->nextPendingConnection())
+    {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        viewers.insert(socket, Viewer());
+
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]()
+                { read(socket); });
+        connect(socket, &QTcpSocket::bytesWritten, this, [this, socket]()
+                { drain(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]()
+                { drop(socket); });
+    }
+}
+
+void BroadcastHub::broadcast(const QByteArray &frame, bool restart)
+{
+    if (restart)
+        history.clear();
+    if (history.size() < maxHistory)
+        history.append(frame);
+
+    // Slow viewers are dropped after the loop so the hash isn't changed while walking it
+    QVector<QTcpSocket *> behind;
+    for (auto it = viewers.begin(); it != viewers.end(); ++it)
+    {
+        if (it.value().upgraded && !enqueue(it.key(), it.value(), frame))
+            behind.append(it.key());
+    }
+
+    for (QTcpSocket *socket : behind)
+        drop(socket);
+}
+
+void BroadcastHub::read(QTcpSocket *socket)
+{
+    auto found = viewers.find(socket);
+    if (found == viewers.end())
+        return;
+
+    Viewer &viewer = found.value();
+    bool ok;
+    if (viewer.upgraded)
+    {
+        viewer.incoming += socket->readAll();
+        ok = readFrames(socket, viewer);
+    }
+    else
+    {
+        ok = readRequest(socket, viewer);
+    }
+
+    if (!ok)
+        drop(socket);
+}
+
+// Answers the HTTP request, either with the viewer page or by upgrading to a WebSocket
+bool BroadcastHub::readRequest(QTcpSocket *socket, Viewer &viewer)
+{
+    // Already answered and closing, anything more from the browser is ignored
+    if (socket->state() != QAbstractSocket::ConnectedState)
+    {
+        socket->readAll();
+        return true;
+    }
+
+    viewer.request += socket->readAll();
+    int end = viewer.request.indexOf("\r\n\r\n");
+    if (end < 0)
+        return viewer.request.size() <= maxRequestBytes;
+
+    QList<QByteArray> lines = viewer.request.left(end).split('\n');
+    QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    QByteArray method = requestLine.value(0);
+    QByteArray path = requestLine.value(1);
+
+    QHash<QByteArray, QByteArray> headers;
+    for (int i = 1; i < lines.size(); ++i)
+    {
+        int colon = lines[i].indexOf(':');
+        if (colon > 0)
+            headers.insert(lines[i].left(colon).trimmed().toLower(), lines[i].mid(colon + 1).trimmed());
+    }
+
+    if (method != "GET")
+    {
+        socket->write(httpResponse("405 Method Not Allowed", "text/plain", "GET only\n"));
+        socket->disconnectFromHost();
+        return true;
+    }
+
+    QByteArray key = headers.value("sec-websocket-key");
+    if (headers.value("upgrade").toLower() == "websocket" && !key.isEmpty())
+    {
+        QByteArray acceptKey = QCryptographicHash::hash(key + webSocketGuid, QCryptographicHash::Sha1).toBase64();
+        socket->write("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: " +
+                      acceptKey + "\r\n\r\n");
+
+        viewer.upgraded = true;
+        viewer.incoming = viewer.request.mid(end + 4);
+        viewer.request.clear();
+        emit owner->clientCountChanged(owner->clients.fetchAndAddRelaxed(1) + 1);
+
+        // Catch the viewer up on the reveal so far
+        for (const QByteArray &event : history)
+        {
+            if (!enqueue(socket, viewer, event))
+                return false;
+        }
+        return readFrames(socket, viewer);
+    }
+
+    if (path == "/" || path == "/index.html")
+        socket->write(httpResponse("200 OK", "text/html; charset=utf-8", viewerPage));
+    else
+        socket->write(httpResponse("404 Not Found", "text/plain", "Not found\n"));
+    socket->disconnectFromHost();
+    return true;
+}
+
+// Handles what viewers send, which is only pings and the closing handshake
+bool BroadcastHub::readFrames(QTcpSocket *socket, Viewer &viewer)
+{
+    while (viewer.incoming.size() >= 2)
+    {
+        const uchar *data = reinterpret_cast<const uchar *>(viewer.incoming.constData());
+        int opcode = data[0] & 0x0f;
+        bool masked = data[1] & 0x80;
+        quint64 length = data[1] & 0x7f;
+        int header = 2;
+
+        if (length == 126)
+        {
+            if (viewer.incoming.size() < 4)
+                return true;
+            length = qFromBigEndian<quint16>(data + 2);
+            header = 4;
+        }
+        else if (length == 127)
+        {
+            if (viewer.incoming.size() < 10)
+                return true;
+            length = qFromBigEndian<quint64>(data + 2);
+            header = 10;
+        }
+
+        if (length > maxViewerPayload)
+            return false;
+
+        int maskAt = header;
+        if (masked)
+            header += 4;
+        if (static_cast<quint64>(viewer.incoming.size()) < header + length)
+            return true;
+
+        QByteArray payload = viewer.incoming.mid(header, static_cast<int>(length));
+        if (masked)
+        {
+            for (int i = 0; i < payload.size(); ++i)
+                payload[i] = static_cast<char>(payload[i] ^ viewer.incoming[maskAt + (i & 3)]);
+        }
+        viewer.incoming.remove(0, header + static_cast<int>(length));
+
+        if (opcode == CloseOpcode)
+        {
+            socket->write(frame(CloseOpcode, QByteArray()));
+            socket->disconnectFromHost();
+            return true;
+        }
+        if (opcode == PingOpcode && !enqueue(socket, viewer, frame(PongOpcode, payload)))
+            return false;
+    }
+    return true;
+}
+
+// Returns false when the viewer has fallen too far behind to keep
+bool BroadcastHub::enqueue(QTcpSocket *socket, Viewer &viewer, const QByteArray &data)
+{
+    if (viewer.pendingBytes + data.size() > maxPendingBytes)
+        return false;
+
+    viewer.pending.push_back(data);
+    viewer.pendingBytes += data.size();
+    drain(socket);
+    return true;
+}
+
+// Moves queued frames into the socket while it has room
+void BroadcastHub::drain(QTcpSocket *socket)
+{
+    auto found = viewers.find(socket);
+    if (found == viewers.end())
+        return;
+
+    Viewer &viewer = found.value();
+    while (!viewer.pending.empty() && socket->bytesToWrite() < socketHighWater)
+    {
+        socket->write(viewer.pending.front());
+        viewer.pendingBytes -= viewer.pending.front().size();
+        viewer.pending.pop_front();
+    }
+}
+
+void BroadcastHub::drop(QTcpSocket *socket)
+{
+    auto found = viewers.find(socket);
+    if (found == viewers.end())
+        return;
+
+    bool upgraded = found.value().upgraded;
+    viewers.erase(found);
+    if (upgraded)
+        emit owner->clientCountChanged(owner->clients.fetchAndAddRelaxed(-1) - 1);
+
+    socket->disconnect(this);
+    socket->abort();
+    socket->deleteLater();
+}
+
+BroadcastServer::BroadcastServer(QObject *parent)
+    : QObject(parent), hub(nullptr), clients(0), listeningPort(0)
+{
+    thread.setObjectName("Broadcast");
+}
+
+BroadcastServer::~BroadcastServer()
+{
+    stop();
+}
+
+bool BroadcastServer::start(quint16 port, QString &error)
+{
+    if (hub)
+        return true;
+
+    hub = new BroadcastHub(this);
+    hub->moveToThread(&thread);
+    thread.start();
+
+    bool listening = false;
+    QMetaObject::invokeMethod(hub, [this, port, &error, &listening]()
+                              { listening = hub->listen(port, error); }, Qt::BlockingQueuedConnection);
+    if (!listening)
+        stop();
+    return listening;
+}
+
+void BroadcastServer::stop()
+{
+    if (!hub)
+        return;
+
+    QMetaObject::invokeMethod(hub, [this]()
+                              { hub->shutdown(); }, Qt::BlockingQueuedConnection);
+    thread.quit();
+    thread.wait();
+
+    delete hub;
+    hub = nullptr;
+}
+
+void BroadcastServer::publish(QJsonObject event)
+{
+    if (!hub)
+        return;
+
+    // Encoded once here, every viewer's queue shares the same bytes
+    event["time"] = QDateTime::currentMSecsSinceEpoch();
+    QByteArray encoded = textFrame(QJsonDocument(event).toJson(QJsonDocument::Compact));
+    bool restart = event.value("type").toString() == "start";
+
+    BroadcastHub *target = hub;
+    QMetaObject::invokeMethod(target, [target, encoded, restart]()
+                              { target->broadcast(encoded, restart); }, Qt::QueuedConnection);
+}
+
+QByteArray BroadcastServer::textFrame(const QByteArray &payload)
+{
+    return frame(TextOpcode, payload);
+}
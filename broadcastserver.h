@@ -0,0 +1,58 @@
+#ifndef BROADCASTSERVER_H
+#define BROADCASTSERVER_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+class BroadcastHub;
+
+// Streams lottery events to spectators on the local network.
+// Browsers get a small viewer page over HTTP, which follows the events over a
+// WebSocket on the same port. Sockets live on the server's own thread with
+// its own event loop, so however many viewers are connected the GUI thread
+// only pays for encoding each event once. The encoded frame is shared by
+// every viewer, each one holds a reference until its socket has room, and a
+// viewer that falls too far behind is disconnected instead of buffered.
+// Viewers that join mid-reveal are caught up on the events so far.
+class BroadcastServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BroadcastServer(QObject *parent = nullptr);
+    ~BroadcastServer();
+
+    // Listens on every interface, returns false with a message when the port can't be used
+    bool start(quint16 port, QString &error);
+    void stop();
+    bool isRunning() const { return hub != nullptr; }
+
+    // The port being listened on, useful after starting on port 0
+    quint16 port() const { return listeningPort; }
+
+    // Sends `event` to every viewer, callable from any thread. A "start" event begins a new reveal.
+    void publish(QJsonObject event);
+
+    int clientCount() const { return clients.loadRelaxed(); }
+
+    // The server side of a WebSocket text frame holding `payload`
+    static QByteArray textFrame(const QByteArray &payload);
+
+signals:
+    // Emitted from the server thread, connect with a queued connection
+    void clientCountChanged(int count);
+
+private:
+    friend class BroadcastHub;
+
+    QThread thread;
+    BroadcastHub *hub;
+    QAtomicInt clients;
+    quint16 listeningPort;
+};
+
+#endif // BROADCASTSERVER_H
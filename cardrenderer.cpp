@@ -0,0 +1,189 @@
+#include "cardrenderer.h"
+#include "teamtablemodel.h"
+
+#include <QFontMetricsF>
+#include <QGuiApplication>
+#include <QPainter>
+
+namespace
+{
+    const QColor cardBackground(30, 30, 30, 240);
+    const QColor eliminationBorder("#555555");
+    const QColor eliminationText("#ff0000");
+    const QColor winnerBorder("#ffd700");
+    const QColor winnerText("#ffd700");
+    const QColor shadowColor(0, 0, 0, 200);
+    const QColor labelBackground(30, 30, 30, 220);
+
+    const qreal cardPadding = 15.0;
+    const qreal labelPadding = 10.0;
+
+    // More distinct strings than any reveal shows, so the cache only resets between reveals
+    const int maxCachedTexts = 512;
+}
+
+CardRenderer::CardRenderer()
+    : ratio(1.0), cardScale(1.0)
+{
+    // Same sizes the cards had as rich text: h2 at 16 pt, h1 at 36 pt and an h3 subtitle
+    eliminationFont = QGuiApplication::font();
+    eliminationFont.setPointSize(16);
+    eliminationFont.setBold(true);
+
+    winnerFont = QGuiApplication::font();
+    winnerFont.setPointSize(36);
+    winnerFont.setBold(true);
+
+    subtitleFont = QGuiApplication::font();
+    subtitleFont.setPointSize(14);
+    subtitleFont.setBold(true);
+
+    labelFont = QGuiApplication::font();
+}
+
+void CardRenderer::setDevicePixelRatio(qreal devicePixelRatio)
+{
+    ratio = devicePixelRatio > 0.0 ? devicePixelRatio : 1.0;
+}
+
+void CardRenderer::setScale(qreal scale)
+{
+    cardScale = scale > 0.0 ? scale : 1.0;
+}
+
+void CardRenderer::warmUp()
+{
+    QString glyphs;
+    for (ushort c = 0x20; c < 0x7f; ++c)
+        glyphs.append(QChar(c));
+    for (ushort c = 0xa1; c <= 0xff; ++c)
+        glyphs.append(QChar(c));
+
+    QImage scratch(QSize(64, 64) * pixelScale(), QImage::Format_ARGB32_Premultiplied);
+    scratch.setDevicePixelRatio(pixelScale());
+    scratch.fill(Qt::transparent);
+
+    QPainter painter(&scratch);
+    for (const QFont &font : {eliminationFont, winnerFont, subtitleFont})
+    {
+        painter.setFont(font);
+        painter.drawText(QPointF(0, 32), glyphs);
+    }
+}
+
+QImage CardRenderer::eliminationCard(const QString &teamName, int odds)
+{
+    QImage card = blankCard(eliminationSize(), eliminationBorder, 10.0);
+    QPainter painter(&card);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+
+    // Long names are shortened so the odds always stay visible
+    QString prefix = "ELIMINATED: ";
+    QString suffix = QString(" - %1 chance of winning").arg(TeamTableModel::formatOdds(odds));
+    QFontMetricsF metrics(eliminationFont);
+    qreal available = eliminationSize().width() - 2 * cardPadding - metrics.horizontalAdvance(prefix + suffix);
+    QString name = metrics.elidedText(teamName, Qt::ElideRight, qMax<qreal>(available, metrics.averageCharWidth()));
+
+    QStaticText text = staticText(prefix + name + suffix, eliminationFont);
+    QPointF position((eliminationSize().width() - text.size().width()) / 2,
+                     (eliminationSize().height() - text.size().height()) / 2);
+    drawShadowedText(painter, position, text, eliminationText, eliminationFont, 2.0);
+    return finished(painter, card);
+}
+
+QImage CardRenderer::winnerCard(const QString &teamName, int odds)
+{
+    QImage card = blankCard(winnerSize(), winnerBorder, 15.0);
+    QPainter painter(&card);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+
+    QFontMetricsF metrics(winnerFont);
+    QString name = metrics.elidedText(teamName, Qt::ElideRight, winnerSize().width() - 2 * cardPadding);
+
+    QStaticText title = staticText(name, winnerFont);
+    QStaticText subtitle = staticText(QString("Won with %1 odds!").arg(TeamTableModel::formatOdds(odds)), subtitleFont);
+
+    // Title and subtitle are centered as one block
+    qreal gap = 12.0;
+    qreal blockHeight = title.size().height() + gap + subtitle.size().height();
+    qreal top = (winnerSize().height() - blockHeight) / 2;
+
+    drawShadowedText(painter, QPointF((winnerSize().width() - title.size().width()) / 2, top), title, winnerText, winnerFont, 2.0);
+    drawShadowedText(painter, QPointF((winnerSize().width() - subtitle.size().width()) / 2, top + title.size().height() + gap),
+                     subtitle, Qt::white, subtitleFont, 0.0);
+    return finished(painter, card);
+}
+
+QImage CardRenderer::labelCard(const QString &text)
+{
+    // Matches the window's status label style sheet: 10 px padding and 5 px corners
+    QStaticText laidOut = staticText(text, labelFont);
+    QSize size = (laidOut.size() + QSizeF(2 * labelPadding, 2 * labelPadding)).toSize();
+
+    QImage card(size * pixelScale(), QImage::Format_ARGB32_Premultiplied);
+    card.setDevicePixelRatio(pixelScale());
+    card.fill(Qt::transparent);
+
+    QPainter painter(&card);
+    painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(labelBackground);
+    painter.drawRoundedRect(QRectF(QPointF(0, 0), QSizeF(size)), 5.0, 5.0);
+
+    drawShadowedText(painter, QPointF(labelPadding, labelPadding), laidOut, Qt::white, labelFont, 0.0);
+    return finished(painter, card);
+}
+
+// Transparent image with the rounded, bordered card background
+QImage CardRenderer::blankCard(const QSize &size, const QColor &border, qreal radius) const
+{
+    QImage card(size * pixelScale(), QImage::Format_ARGB32_Premultiplied);
+    card.setDevicePixelRatio(pixelScale());
+    card.fill(Qt::transparent);
+
+    QPainter painter(&card);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(border, 2.0));
+    painter.setBrush(cardBackground);
+    painter.drawRoundedRect(QRectF(QPointF(0, 0), QSizeF(size)).adjusted(1, 1, -1, -1), radius, radius);
+    return card;
+}
+
+// Cards are painted in nominal units, once done they report the scaled size
+QImage CardRenderer::finished(QPainter &painter, QImage &card) const
+{
+    painter.end();
+    card.setDevicePixelRatio(ratio);
+    return card;
+}
+
+QStaticText CardRenderer::staticText(const QString &text, const QFont &font)
+{
+    QString key = font.key() + QLatin1Char('\n') + text;
+    auto found = textCache.constFind(key);
+    if (found != textCache.constEnd())
+        return found.value();
+
+    if (textCache.size() >= maxCachedTexts)
+        textCache.clear();
+
+    QStaticText laidOut(text);
+    laidOut.setTextFormat(Qt::PlainText);
+    laidOut.setPerformanceHint(QStaticText::AggressiveCaching);
+    laidOut.prepare(QTransform(), font);
+    return textCache.insert(key, laidOut).value();
+}
+
+// A hard offset shadow stands in for the CSS text-shadow the rich-text labels used
+void CardRenderer::drawShadowedText(QPainter &painter, const QPointF &position, const QStaticText &text,
+                                    const QColor &color, const QFont &font, qreal shadowOffset) const
+{
+    painter.setFont(font);
+    if (shadowOffset > 0.0)
+    {
+        painter.setPen(shadowColor);
+        painter.drawStaticText(position + QPointF(shadowOffset, shadowOffset), text);
+    }
+    painter.setPen(color);
+    painter.drawStaticText(position, text);
+}
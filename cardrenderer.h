@@ -0,0 +1,64 @@
+#ifndef CARDRENDERER_H
+#define CARDRENDERER_H
+
+#include <QColor>
+#include <QFont>
+#include <QHash>
+#include <QImage>
+#include <QSize>
+#include <QStaticText>
+#include <QString>
+
+// Paints the elimination and winner cards into images.
+// Text is laid out once per string as QStaticText and the card frame is plain
+// QPainter drawing, so a card costs no rich-text parsing or style polish.
+// warmUp() rasterizes the card fonts' glyphs ahead of the reveal so the
+// first card does not pay for them. Images are safe to render off the GUI
+// thread, which the frame exporter relies on.
+class CardRenderer
+{
+public:
+    CardRenderer();
+
+    // Renders at this many device pixels per logical pixel
+    void setDevicePixelRatio(qreal ratio);
+    qreal devicePixelRatio() const { return ratio; }
+
+    // Cards come out this many times their nominal size, rasterized at that size
+    // rather than scaled up later, and tagged with devicePixelRatio() so a
+    // widget blits them 1:1. The window scales its reveal with its height.
+    void setScale(qreal scale);
+    qreal scale() const { return cardScale; }
+
+    // Draws every printable Latin-1 glyph of the card fonts once into a scratch image
+    void warmUp();
+
+    QImage eliminationCard(const QString &teamName, int odds);
+    QImage winnerCard(const QString &teamName, int odds);
+
+    // The small status box, like "Drawing lottery...", sized to its text
+    QImage labelCard(const QString &text);
+
+    static QSize eliminationSize() { return QSize(750, 100); }
+    static QSize winnerSize() { return QSize(700, 300); }
+
+private:
+    QImage blankCard(const QSize &size, const QColor &border, qreal radius) const;
+    QImage finished(QPainter &painter, QImage &card) const;
+    qreal pixelScale() const { return ratio * cardScale; }
+    QStaticText staticText(const QString &text, const QFont &font);
+    void drawShadowedText(QPainter &painter, const QPointF &position, const QStaticText &text,
+                          const QColor &color, const QFont &font, qreal shadowOffset) const;
+
+    qreal ratio;
+    qreal cardScale;
+    QFont eliminationFont;
+    QFont winnerFont;
+    QFont subtitleFont;
+    QFont labelFont;
+
+    // Laid out text keyed by font and string, cleared when it grows past a reveal's worth
+    QHash<QString, QStaticText> textCache;
+};
+
+#endif // CARDRENDERER_H
@@ -0,0 +1,214 @@
+#include "confettioverlay.h"
+#include "confettisystem.h"
+
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Confetti colors, indexed by ConfettiSystem::color()
+    const QColor confettiColors[ConfettiSystem::colorCount] = {
+        QColor("#ffd700"), QColor("#ff0000"), QColor("#00ff00"), QColor("#0000ff"),
+        QColor("#ff00ff"), QColor("#00ffff"), QColor("#ff8000")};
+
+    // Squares look the same every 90 degrees, so that is all the atlas has to cover
+    const int rotationSteps = 24;
+    const qreal stepDegrees = 90.0 / rotationSteps;
+
+    // Sprites are drawn at the largest confetti size and scaled down per particle,
+    // the cell leaves room for the rotated corners
+    const qreal spriteSize = 15.0;
+    const int cellSize = 24;
+
+    const int tileSize = 64;
+}
+
+ConfettiOverlay::ConfettiOverlay(const ConfettiSystem *system, QWidget *parent)
+    : QWidget(parent), system(system), atlasRatio(0.0), sceneScale(1.0), tileColumns(0), tileRows(0)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAttribute(Qt::WA_NoSystemBackground);
+}
+
+void ConfettiOverlay::advance()
+{
+    QRegion dirty = markTiles();
+    if (!dirty.isEmpty())
+        update(dirty);
+}
+
+void ConfettiOverlay::clear()
+{
+    previousTiles.fill(0);
+    update();
+}
+
+void ConfettiOverlay::setSceneScale(qreal scale)
+{
+    if (qFuzzyCompare(sceneScale, scale) || scale <= 0.0)
+        return;
+    sceneScale = scale;
+    clear();
+}
+
+void ConfettiOverlay::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    paintParticles(painter, event->rect());
+}
+
+void ConfettiOverlay::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+
+    tileColumns = (width() + tileSize - 1) / tileSize;
+    tileRows = (height() + tileSize - 1) / tileSize;
+    previousTiles.fill(0, tileColumns * tileRows);
+    currentTiles.fill(0, tileColumns * tileRows);
+}
+
+void ConfettiOverlay::paintParticles(QPainter &painter, const QRect &area)
+{
+    const qreal ratio = painter.device()->devicePixelRatioF() * sceneScale;
+    if (atlas.isNull() || !qFuzzyCompare(atlasRatio, ratio))
+        buildAtlas(ratio);
+
+    const float *x = system->x();
+    const float *y = system->y();
+    const float *rotations = system->rotation();
+    const float *sizes = system->particleSize();
+    const quint8 *colors = system->color();
+
+    // `area` is in widget pixels, the particles are in scene units
+    const QRectF sceneArea(QPointF(area.topLeft()) / sceneScale, QSizeF(area.size()) / sceneScale);
+    const QRectF visible = sceneArea.adjusted(-cellSize, -cellSize, cellSize, cellSize);
+
+    fragments.clear();
+    fragments.reserve(system->size());
+
+    for (int i = 0; i < system->size(); ++i)
+    {
+        if (!visible.contains(x[i], y[i]))
+            continue;
+
+        qreal scale = sizes[i] * sceneScale / (spriteSize * atlasRatio);
+        fragments.append(QPainter::PixmapFragment::create(QPointF(x[i], y[i]) * sceneScale, spriteSource(rotations[i], colors[i], atlasRatio),
+                                                          scale, scale));
+    }
+
+    if (!fragments.isEmpty())
+        painter.drawPixmapFragments(fragments.constData(), fragments.size(), atlas);
+}
+
+// Renders every color at every rotation step once, at the screen's pixel ratio times the scene scale
+void ConfettiOverlay::buildAtlas(qreal ratio)
+{
+    atlasRatio = ratio;
+    atlas = QPixmap::fromImage(spriteAtlas(ratio));
+}
+
+QImage ConfettiOverlay::spriteAtlas(qreal ratio)
+{
+    const int cellPixels = qRound(cellSize * ratio);
+
+    QImage image(cellPixels * rotationSteps, cellPixels * ConfettiSystem::colorCount, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+
+    const qreal side = spriteSize * ratio;
+    for (int color = 0; color < ConfettiSystem::colorCount; ++color)
+    {
+        for (int step = 0; step < rotationSteps; ++step)
+        {
+            painter.resetTransform();
+            painter.translate((step + 0.5) * cellPixels, (color + 0.5) * cellPixels);
+            painter.rotate(step * stepDegrees);
+            painter.fillRect(QRectF(-side / 2, -side / 2, side, side), confettiColors[color]);
+        }
+    }
+    return image;
+}
+
+QRectF ConfettiOverlay::spriteSource(float rotation, int color, qreal ratio)
+{
+    // Pick the pre-rotated sprite closest to this particle's angle
+    qreal angle = std::fmod(static_cast<qreal>(rotation), 90.0);
+    if (angle < 0)
+        angle += 90.0;
+    int step = qRound(angle / stepDegrees) % rotationSteps;
+
+    const int cellPixels = qRound(cellSize * ratio);
+    return QRectF(step * cellPixels, color * cellPixels, cellPixels, cellPixels);
+}
+
+QRectF ConfettiOverlay::spriteTarget(float x, float y, float size)
+{
+    // The sprite square fills spriteSize of the cell, so the cell scales with the particle
+    qreal side = cellSize * size / spriteSize;
+    return QRectF(x - side / 2, y - side / 2, side, side);
+}
+
+// Marks the tiles under every particle and returns the union of those and last frame's tiles
+QRegion ConfettiOverlay::markTiles()
+{
+    if (tileColumns == 0 || tileRows == 0)
+        return QRegion();
+
+    currentTiles.fill(0);
+
+    const float *x = system->x();
+    const float *y = system->y();
+    const float *sizes = system->particleSize();
+    const float scale = static_cast<float>(sceneScale);
+
+    for (int i = 0; i < system->size(); ++i)
+    {
+        // Half the diagonal covers the square at any rotation
+        float reach = (sizes[i] * 0.71f + 1.0f) * scale;
+        float px = x[i] * scale;
+        float py = y[i] * scale;
+        int left = std::max(0, static_cast<int>(px - reach) / tileSize);
+        int right = std::min(tileColumns - 1, static_cast<int>(px + reach) / tileSize);
+        int top = std::max(0, static_cast<int>(py - reach) / tileSize);
+        int bottom = std::min(tileRows - 1, static_cast<int>(py + reach) / tileSize);
+
+        for (int row = top; row <= bottom; ++row)
+        {
+            for (int column = left; column <= right; ++column)
+                currentTiles[row * tileColumns + column] = 1;
+        }
+    }
+
+    // Merge runs of dirty tiles on each row into single rectangles
+    QRegion dirty;
+    for (int row = 0; row < tileRows; ++row)
+    {
+        int column = 0;
+        while (column < tileColumns)
+        {
+            int index = row * tileColumns + column;
+            if (!(currentTiles[index] | previousTiles[index]))
+            {
+                ++column;
+                continue;
+            }
+
+            int start = column;
+            while (column < tileColumns && (currentTiles[row * tileColumns + column] | previousTiles[row * tileColumns + column]))
+                ++column;
+
+            dirty += QRect(start * tileSize, row * tileSize, (column - start) * tileSize, tileSize);
+        }
+    }
+
+    previousTiles.swap(currentTiles);
+    return dirty;
+}
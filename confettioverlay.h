@@ -0,0 +1,69 @@
+#ifndef CONFETTIOVERLAY_H
+#define CONFETTIOVERLAY_H
+
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QRegion>
+#include <QVector>
+#include <QWidget>
+
+class ConfettiSystem;
+
+// Transparent overlay that draws a ConfettiSystem.
+// Every color and rotation step is rendered once into a sprite atlas and the
+// whole frame goes out in a single drawPixmapFragments call. Only screen
+// tiles that held a particle last frame or hold one now are repainted.
+class ConfettiOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ConfettiOverlay(const ConfettiSystem *system, QWidget *parent = nullptr);
+
+    // Schedules a repaint of the area the particles moved through since the last frame
+    void advance();
+
+    // Forgets the previous frame, call when the particles were reset
+    void clear();
+
+    // Particles live in scene units, drawn at this many logical pixels per unit.
+    // The sprites are rasterized at the drawn size, not scaled up.
+    void setSceneScale(qreal scale);
+
+    // Draws the particles intersecting `area` with the given painter
+    void paintParticles(QPainter &painter, const QRect &area);
+
+    // Every color at every rotation step, `ratio` device pixels per logical pixel.
+    // Only touches QImage, so it can be built off the GUI thread.
+    static QImage spriteAtlas(qreal ratio);
+
+    // Atlas cell of the sprite closest to a particle's rotation, in atlas pixels
+    static QRectF spriteSource(float rotation, int color, qreal ratio);
+
+    // Logical rectangle a particle's atlas cell covers when drawn at `size`
+    static QRectF spriteTarget(float x, float y, float size);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void buildAtlas(qreal ratio);
+    QRegion markTiles();
+
+    const ConfettiSystem *system;
+
+    QPixmap atlas;
+    qreal atlasRatio;
+    qreal sceneScale;
+    QVector<QPainter::PixmapFragment> fragments;
+
+    // One byte per tile, set for tiles touched by particles in the last frame
+    QVector<quint8> previousTiles;
+    QVector<quint8> currentTiles;
+    int tileColumns;
+    int tileRows;
+};
+
+#endif // CONFETTIOVERLAY_H
@@ -0,0 +1,141 @@
+#include "confettisystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const float gravity = 0.1f;
+    const float twoPi = 6.28318530718f;
+
+    // Largest confetti is 15 px, keep it alive until it is fully off screen
+    const float offscreenMargin = 16.0f;
+}
+
+ConfettiSystem::ConfettiSystem(int capacity, std::uint64_t seed)
+    : posX(capacity), posY(capacity), velX(capacity), velY(capacity),
+      angle(capacity), spin(capacity), side(capacity), colorIndex(capacity)
+{
+    setSeed(seed);
+}
+
+void ConfettiSystem::reset()
+{
+    count = 0;
+    emitting = false;
+}
+
+void ConfettiSystem::setSeed(std::uint64_t seed)
+{
+    // xorshift must never hold an all-zero state
+    state = seed ? seed : 0x9E3779B97F4A7C15ull;
+}
+
+void ConfettiSystem::setBounds(float w, float h)
+{
+    width = w;
+    height = h;
+}
+
+void ConfettiSystem::burst(float x, float y, int amount)
+{
+    int end = std::min(count + amount, capacity());
+    for (int i = count; i < end; ++i)
+    {
+        spawn(i, x, y);
+    }
+    count = end;
+}
+
+void ConfettiSystem::setEmitter(float x, float y, bool enabled)
+{
+    emitterX = x;
+    emitterY = y;
+    emitting = enabled;
+}
+
+// Simulates confetti falling and spinning
+void ConfettiSystem::update()
+{
+    const int n = count;
+    float *__restrict px = posX.data();
+    float *__restrict py = posY.data();
+    float *__restrict vx = velX.data();
+    float *__restrict vy = velY.data();
+    float *__restrict rot = angle.data();
+    const float *__restrict rotSpeed = spin.data();
+
+    // Branch-free loops over contiguous arrays, these vectorize at -O3
+    for (int i = 0; i < n; ++i)
+    {
+        px[i] += vx[i];
+        py[i] += vy[i];
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        vy[i] += gravity;
+        rot[i] += rotSpeed[i];
+    }
+
+    // Recycle anything that left the screen. Confetti only speeds up as it
+    // falls, so once it is below the bottom edge it never comes back.
+    const float bottom = height + offscreenMargin;
+    const float left = -offscreenMargin;
+    const float right = width + offscreenMargin;
+
+    int i = 0;
+    while (i < count)
+    {
+        bool gone = py[i] > bottom || px[i] < left || px[i] > right;
+        if (!gone)
+        {
+            ++i;
+            continue;
+        }
+
+        if (emitting)
+        {
+            spawn(i, emitterX, emitterY);
+            ++i;
+        }
+        else
+        {
+            // Fill the hole with the last live particle and check it next
+            int last = --count;
+            posX[i] = posX[last];
+            posY[i] = posY[last];
+            velX[i] = velX[last];
+            velY[i] = velY[last];
+            angle[i] = angle[last];
+            spin[i] = spin[last];
+            side[i] = side[last];
+            colorIndex[i] = colorIndex[last];
+        }
+    }
+}
+
+// Initially moves upwards, then falls down simulating gravity
+void ConfettiSystem::spawn(int index, float x, float y)
+{
+    float direction = nextUnit() * twoPi;
+    float speed = 1.0f + nextUnit() * 4.0f; // Range 1 - 5
+
+    posX[index] = x;
+    posY[index] = y;
+    velX[index] = speed * std::cos(direction);
+    velY[index] = speed * std::sin(direction) - 3.0f; // Initial upward velocity
+    angle[index] = nextUnit() * 360.0f;
+    spin[index] = -5.0f + nextUnit() * 10.0f; // Range -5-5
+    side[index] = 5.0f + nextUnit() * 10.0f;  // Range 5-15
+    colorIndex[index] = static_cast<std::uint8_t>(nextUnit() * colorCount) % colorCount;
+}
+
+// xorshift64*, plenty for visual randomness and much cheaper than a secure generator
+float ConfettiSystem::nextUnit()
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    std::uint64_t bits = state * 0x2545F4914F6CDD1Dull;
+    return static_cast<float>(bits >> 40) * (1.0f / 16777216.0f);
+}
@@ -0,0 +1,63 @@
+#ifndef CONFETTISYSTEM_H
+#define CONFETTISYSTEM_H
+
+#include <cstdint>
+#include <vector>
+
+// Confetti stored as a structure of arrays so the per-frame update runs as
+// straight loops over contiguous floats that the compiler vectorizes.
+// Live particles are always packed in [0, size()). A particle that leaves the
+// screen is either respawned at the emitter (while emitting) or swapped out
+// with the last live one, so the arrays are allocated once and reused.
+class ConfettiSystem
+{
+public:
+    explicit ConfettiSystem(int capacity, std::uint64_t seed = 0);
+
+    void reset();
+    void setSeed(std::uint64_t seed);
+    void setBounds(float width, float height);
+
+    // Spawns up to `count` particles at the given point
+    void burst(float x, float y, int count);
+
+    // While emitting, particles that fall off screen are recycled at the emitter
+    void setEmitter(float x, float y, bool emitting);
+
+    // Advances the simulation by one 16 ms frame
+    void update();
+
+    int size() const { return count; }
+    int capacity() const { return static_cast<int>(posX.size()); }
+
+    const float *x() const { return posX.data(); }
+    const float *y() const { return posY.data(); }
+    const float *rotation() const { return angle.data(); }
+    const float *particleSize() const { return side.data(); }
+    const std::uint8_t *color() const { return colorIndex.data(); }
+
+    static const int colorCount = 7;
+
+private:
+    void spawn(int index, float x, float y);
+    float nextUnit();
+
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> velX;
+    std::vector<float> velY;
+    std::vector<float> angle;
+    std::vector<float> spin;
+    std::vector<float> side;
+    std::vector<std::uint8_t> colorIndex;
+
+    int count = 0;
+    float width = 0.0f;
+    float height = 0.0f;
+    float emitterX = 0.0f;
+    float emitterY = 0.0f;
+    bool emitting = false;
+    std::uint64_t state = 0;
+};
+
+#endif // CONFETTISYSTEM_H
@@ -0,0 +1,56 @@
+# Window and reveal sources shared by the app and the benchmark suite
+include($$PWD/lotteryengine/lotteryengine.pri)
+
+# The spectator server streams reveals over the local network
+QT += network
+
+# Soak mode reads the process's private bytes
+win32: LIBS += -lpsapi
+
+# Trace points above this level compile out, 0 removes every one (see tracer.h)
+DEFINES += DRAFTLOTTERY_TRACE_LEVEL=1
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/broadcastserver.cpp \
+    $$PWD/cardrenderer.cpp \
+    $$PWD/confettioverlay.cpp \
+    $$PWD/confettisystem.cpp \
+    $$PWD/frametimehud.cpp \
+    $$PWD/mainwindow.cpp \
+    $$PWD/oddsexplorer.cpp \
+    $$PWD/pickoddsdialog.cpp \
+    $$PWD/revealcard.cpp \
+    $$PWD/revealexporter.cpp \
+    $$PWD/revealtimeline.cpp \
+    $$PWD/soakrunner.cpp \
+    $$PWD/startupprofiler.cpp \
+    $$PWD/teamimporter.cpp \
+    $$PWD/teamtablemodel.cpp \
+    $$PWD/tracer.cpp
+
+HEADERS += \
+    $$PWD/broadcastserver.h \
+    $$PWD/cardrenderer.h \
+    $$PWD/confettioverlay.h \
+    $$PWD/confettisystem.h \
+    $$PWD/frametimehud.h \
+    $$PWD/mainwindow.h \
+    $$PWD/oddsexplorer.h \
+    $$PWD/pickoddsdialog.h \
+    $$PWD/revealcard.h \
+    $$PWD/revealexporter.h \
+    $$PWD/revealtimeline.h \
+    $$PWD/soakrunner.h \
+    $$PWD/startupprofiler.h \
+    $$PWD/teamimporter.h \
+    $$PWD/teamtablemodel.h \
+    $$PWD/tracer.h
+
+FORMS += \
+    $$PWD/mainwindow.ui
+
+RESOURCES += \
+    $$PWD/resources.qrc
@@ -1,29 +1,14 @@
-QT      = core gui
+TEMPLATE = subdirs
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+# The draw logic lives in a GUI-free static library so simulations and
+# raffles can run it without a window
+SUBDIRS += \
+    lotteryengine \
+    app \
+    bench \
+    loadtest
 
-CONFIG += c++17
-QMAKE_CXXFLAGS_RELEASE += -O3
-CONFIG += optimize_full
+app.file = draftlotteryapp.pro
+app.depends = lotteryengine
 
-# You can make your code fail to compile if it uses deprecated APIs.
-# In order to do so, uncomment the following line.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
-
-SOURCES += \
-    main.cpp \
-    mainwindow.cpp
-
-HEADERS += \
-    mainwindow.h
-
-FORMS += \
-    mainwindow.ui
-
-# Default rules for deployment.
-qnx: target.path = /tmp/$${TARGET}/bin
-else: unix:!android: target.path = /opt/$${TARGET}/bin
-!isEmpty(target.path): INSTALLS += target
-
-RESOURCES += \
-    resources.qrc
+bench.depends = lotteryengine
@@ -0,0 +1,229 @@
+#include "frametimehud.h"
+
+#include <QApplication>
+#include <QEvent>
+#include <QLayout>
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Qt's animation driver and the confetti timer both aim for 16 ms frames
+    const double expectedInterval = 16.0;
+
+    // A frame later than this counts as dropped
+    const double droppedThreshold = expectedInterval * 1.5;
+}
+
+FrameTimingHud::FrameTimingHud(QWidget *parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    clock.start();
+
+    refreshTimer.setInterval(250);
+    connect(&refreshTimer, &QTimer::timeout, this, &FrameTimingHud::refresh);
+
+    hide();
+}
+
+FrameTimingHud::~FrameTimingHud()
+{
+    qDeleteAll(sources);
+}
+
+void FrameTimingHud::setActive(bool active)
+{
+    if (active)
+    {
+        // Start every source with a clean window
+        for (Source *s : sources)
+        {
+            *s = Source{s->name};
+        }
+        refresh();
+        show();
+        raise();
+        refreshTimer.start();
+        qApp->installEventFilter(this);
+    }
+    else
+    {
+        qApp->removeEventFilter(this);
+        refreshTimer.stop();
+        hide();
+    }
+}
+
+void FrameTimingHud::watchAnimation(QVariantAnimation *animation, const QString &name)
+{
+    Source *s = source(name);
+    connect(animation, &QVariantAnimation::valueChanged, this, [this, s]()
+            { recordFrame(s); });
+
+    // Pauses between animations are not dropped frames
+    connect(animation, &QAbstractAnimation::stateChanged, this, [s](QAbstractAnimation::State newState)
+            {
+        if (newState == QAbstractAnimation::Running)
+            s->lastFrame = -1; });
+}
+
+void FrameTimingHud::watchTimer(QTimer *timer, const QString &name)
+{
+    Source *s = source(name);
+    s->lastFrame = -1;
+    connect(timer, &QTimer::timeout, this, [this, s]()
+            { recordFrame(s); });
+}
+
+void FrameTimingHud::watchPaint(QWidget *widget, const QString &name)
+{
+    paintSources.insert(widget, source(name));
+    connect(widget, &QObject::destroyed, this, [this](QObject *object)
+            { paintSources.remove(object); layoutSources.remove(object); });
+}
+
+void FrameTimingHud::watchLayout(QWidget *widget, const QString &name)
+{
+    layoutSources.insert(widget, source(name));
+    connect(widget, &QObject::destroyed, this, [this](QObject *object)
+            { paintSources.remove(object); layoutSources.remove(object); });
+}
+
+// Delivers paint and layout events itself so it can time them. This runs as an
+// application filter because Qt activates a widget's layout before the widget's
+// own filters see the LayoutRequest, so they could never time the layout pass.
+bool FrameTimingHud::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() != QEvent::Paint && event->type() != QEvent::LayoutRequest)
+        return QWidget::eventFilter(watched, event);
+
+    QHash<QObject *, Source *> &table = event->type() == QEvent::Paint ? paintSources : layoutSources;
+    Source *s = table.value(watched);
+    if (!s)
+        return QWidget::eventFilter(watched, event);
+
+    QWidget *widget = static_cast<QWidget *>(watched);
+    QElapsedTimer timer;
+    timer.start();
+
+    // The same layout pass Qt would run before delivering the request
+    if (event->type() == QEvent::LayoutRequest && widget->layout() && widget->isVisible())
+        widget->layout()->activate();
+    widget->event(event);
+    double elapsed = timer.nsecsElapsed() / 1e6;
+
+    if (event->type() == QEvent::Paint)
+        s->paint.add(elapsed);
+    else
+        s->layout.add(elapsed);
+
+    // Already delivered, Qt must not deliver it a second time
+    return true;
+}
+
+FrameTimingHud::Source *FrameTimingHud::source(const QString &name)
+{
+    for (Source *s : sources)
+    {
+        if (s->name == name)
+            return s;
+    }
+
+    Source *s = new Source{name};
+    sources.append(s);
+    return s;
+}
+
+void FrameTimingHud::recordFrame(Source *s)
+{
+    if (!isVisible())
+        return;
+
+    qint64 now = clock.nsecsElapsed();
+    if (s->lastFrame >= 0)
+    {
+        double interval = (now - s->lastFrame) / 1e6;
+        s->interval.add(interval);
+        s->jitter.add(std::abs(interval - expectedInterval));
+
+        // Count every frame slot that went by without a frame
+        if (interval > droppedThreshold)
+            s->dropped += static_cast<int>(interval / expectedInterval) - 1;
+    }
+    s->lastFrame = now;
+}
+
+// Rebuilds the text a few times a second rather than on every frame
+void FrameTimingHud::refresh()
+{
+    auto pair = [](const SlidingWindow &window)
+    {
+        if (window.isEmpty())
+            return QString("  -  /  -  ");
+        return QString("%1 / %2").arg(window.percentile(0.5), 5, 'f', 1).arg(window.percentile(0.99), 5, 'f', 1);
+    };
+
+    lines.clear();
+    lines.append("p50 / p99 ms       interval       paint      jitter    layout  dropped");
+    for (const Source *s : sources)
+    {
+        lines.append(QString("%1 %2 %3 %4 %5 %6")
+                         .arg(s->name, -12)
+                         .arg(pair(s->interval), 13)
+                         .arg(pair(s->paint), 13)
+                         .arg(pair(s->jitter), 13)
+                         .arg(pair(s->layout), 13)
+                         .arg(s->dropped, 6));
+    }
+
+    QFont font("Monospace");
+    font.setStyleHint(QFont::TypeWriter);
+    font.setPointSize(9);
+    setFont(font);
+
+    QFontMetrics metrics(font);
+    int textWidth = 0;
+    for (const QString &line : lines)
+    {
+        textWidth = std::max(textWidth, metrics.horizontalAdvance(line));
+    }
+    setGeometry(8, 28, textWidth + 16, metrics.height() * lines.size() + 12);
+
+    // Cards are raised as they appear, stay on top of them
+    raise();
+    update();
+}
+
+void FrameTimingHud::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(0, 0, 0, 190));
+    painter.setPen(QColor(120, 255, 120));
+
+    QFontMetrics metrics(font());
+    int y = 6 + metrics.ascent();
+    for (const QString &line : lines)
+    {
+        painter.drawText(8, y, line);
+        y += metrics.height();
+    }
+}
+
+void FrameTimingHud::SlidingWindow::add(double value)
+{
+    samples[next] = value;
+    next = (next + 1) % samples.size();
+    filled = std::min(filled + 1, static_cast<int>(samples.size()));
+}
+
+double FrameTimingHud::SlidingWindow::percentile(double p) const
+{
+    QVector<double> sorted = samples.mid(0, filled);
+    int rank = std::min(filled - 1, static_cast<int>(std::ceil(p * filled)) - 1);
+    rank = std::max(rank, 0);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
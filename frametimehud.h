@@ -0,0 +1,80 @@
+#ifndef FRAMETIMEHUD_H
+#define FRAMETIMEHUD_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTimer>
+#include <QVariantAnimation>
+#include <QVector>
+#include <QWidget>
+
+// Toggleable on-screen readout of animation frame timing.
+// Each watched source (an animation, a timer, a widget's paint or layout)
+// keeps a sliding window of samples, and the overlay shows p50/p99 of frame
+// interval, paint duration and timer jitter plus a dropped frame count.
+// Nothing is recorded while the overlay is hidden.
+class FrameTimingHud : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FrameTimingHud(QWidget *parent = nullptr);
+    ~FrameTimingHud();
+
+    // Every value change of the animation counts as one frame
+    void watchAnimation(QVariantAnimation *animation, const QString &source);
+
+    // Every timeout of the timer counts as one frame
+    void watchTimer(QTimer *timer, const QString &source);
+
+    // Times the widget's paint events
+    void watchPaint(QWidget *widget, const QString &source);
+
+    // Times the widget's layout passes: its layout's activation and its own handling of the request
+    void watchLayout(QWidget *widget, const QString &source);
+
+    void setActive(bool active);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    // Fixed-size ring of the most recent samples in milliseconds
+    class SlidingWindow
+    {
+    public:
+        void add(double value);
+        double percentile(double p) const;
+        bool isEmpty() const { return filled == 0; }
+
+    private:
+        QVector<double> samples = QVector<double>(240, 0.0);
+        int next = 0;
+        int filled = 0;
+    };
+
+    struct Source
+    {
+        QString name;
+        SlidingWindow interval;
+        SlidingWindow jitter;
+        SlidingWindow paint;
+        SlidingWindow layout;
+        qint64 lastFrame = -1;
+        int dropped = 0;
+    };
+
+    Source *source(const QString &name);
+    void recordFrame(Source *source);
+    void refresh();
+
+    QVector<Source *> sources;
+    QHash<QObject *, Source *> paintSources;
+    QHash<QObject *, Source *> layoutSources;
+    QElapsedTimer clock;
+    QTimer refreshTimer;
+    QStringList lines;
+};
+
+#endif // FRAMETIMEHUD_H
@@ -0,0 +1,17 @@
+TARGET = draftlottery-loadtest
+QT      = core network
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+QMAKE_CXXFLAGS_RELEASE += -O3
+CONFIG += optimize_full
+
+# Load tests the same spectator server the app runs
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../broadcastserver.cpp \
+    main.cpp
+
+HEADERS += \
+    ../broadcastserver.h
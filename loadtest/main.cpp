@@ -0,0 +1,326 @@
+#include "broadcastserver.h"
+
+#include <QAtomicInt>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRandomGenerator>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    // Sorted copy's value at fraction p, 0 when empty
+    double percentile(QVector<qint64> values, double p)
+    {
+        if (values.isEmpty())
+            return 0.0;
+        std::sort(values.begin(), values.end());
+        return values[std::min<int>(values.size() - 1, static_cast<int>(p * values.size()))];
+    }
+
+    // Every viewer keeps a socket open, two per viewer when the server runs in this process
+    void raiseFileLimit()
+    {
+#ifdef Q_OS_UNIX
+        rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+#endif
+    }
+}
+
+// Simulated spectators, all on one thread with its own event loop.
+// Each one upgrades to a WebSocket like the viewer page does and records
+// how long every event took from publish to arrival. Slow viewers stop
+// reading after the handshake, to exercise the server's backpressure.
+class ViewerSwarm : public QObject
+{
+public:
+    void connectViewers(const QString &host, quint16 port, int count, int slow)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            Viewer *viewer = new Viewer{new QTcpSocket(this), QByteArray(), false, i < slow};
+            QTcpSocket *socket = viewer->socket;
+
+            connect(socket, &QTcpSocket::connected, this, [socket, host]()
+                    {
+                QByteArray key = QByteArray::number(QRandomGenerator::global()->generate64()).toBase64();
+                socket->write("GET /events HTTP/1.1\r\nHost: " + host.toUtf8() + "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                              "Sec-WebSocket-Key: " + key + "\r\nSec-WebSocket-Version: 13\r\n\r\n"); });
+            connect(socket, &QTcpSocket::readyRead, this, [this, viewer]()
+                    { read(viewer); });
+            connect(socket, &QTcpSocket::disconnected, this, [this, viewer]()
+                    {
+                if (viewer->upgraded)
+                    dropped.fetchAndAddRelaxed(1);
+                viewer->upgraded = false; });
+            connect(socket, &QTcpSocket::errorOccurred, this, [this, viewer](QAbstractSocket::SocketError)
+                    {
+                if (!viewer->upgraded)
+                    failed.fetchAndAddRelaxed(1); });
+
+            socket->connectToHost(host, port);
+            viewers.append(viewer);
+        }
+    }
+
+    void disconnectViewers()
+    {
+        for (Viewer *viewer : viewers)
+        {
+            viewer->socket->disconnect(this);
+            viewer->socket->abort();
+            delete viewer;
+        }
+        viewers.clear();
+    }
+
+    QVector<qint64> takeLatencies()
+    {
+        QMutexLocker locker(&latencyMutex);
+        return latencies;
+    }
+
+    QAtomicInt connected = 0;
+    QAtomicInt failed = 0;
+    QAtomicInt dropped = 0;
+    QAtomicInt messages = 0;
+
+private:
+    struct Viewer
+    {
+        QTcpSocket *socket;
+        QByteArray buffer;
+        bool upgraded;
+        bool slow;
+    };
+
+    void read(Viewer *viewer)
+    {
+        if (viewer->upgraded && viewer->slow)
+            return;
+
+        viewer->buffer += viewer->socket->readAll();
+
+        if (!viewer->upgraded)
+        {
+            int end = viewer->buffer.indexOf("\r\n\r\n");
+            if (end < 0)
+                return;
+            if (!viewer->buffer.startsWith("HTTP/1.1 101"))
+            {
+                failed.fetchAndAddRelaxed(1);
+                viewer->socket->abort();
+                return;
+            }
+
+            viewer->upgraded = true;
+            viewer->buffer.remove(0, end + 4);
+            connected.fetchAndAddRelaxed(1);
+
+            // Slow viewers leave everything in the kernel buffers from now on
+            if (viewer->slow)
+            {
+                viewer->socket->setReadBufferSize(1);
+                return;
+            }
+        }
+
+        // Server frames are never masked
+        while (viewer->buffer.size() >= 2)
+        {
+            const uchar *data = reinterpret_cast<const uchar *>(viewer->buffer.constData());
+            quint64 length = data[1] & 0x7f;
+            int header = 2;
+            if (length == 126)
+            {
+                if (viewer->buffer.size() < 4)
+                    return;
+                length = qFromBigEndian<quint16>(data + 2);
+                header = 4;
+            }
+            else if (length == 127)
+            {
+                if (viewer->buffer.size() < 10)
+                    return;
+                length = qFromBigEndian<quint64>(data + 2);
+                header = 10;
+            }
+            if (static_cast<quint64>(viewer->buffer.size()) < header + length)
+                return;
+
+            QJsonObject event = QJsonDocument::fromJson(viewer->buffer.mid(header, static_cast<int>(length))).object();
+            viewer->buffer.remove(0, header + static_cast<int>(length));
+
+            qint64 latency = QDateTime::currentMSecsSinceEpoch() - static_cast<qint64>(event.value("time").toDouble());
+            messages.fetchAndAddRelaxed(1);
+            QMutexLocker locker(&latencyMutex);
+            latencies.append(latency);
+        }
+    }
+
+    QVector<Viewer *> viewers;
+    QMutex latencyMutex;
+    QVector<qint64> latencies;
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("draftlottery-loadtest");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Connects many simulated viewers to the spectator server and measures delivery.");
+    parser.addHelpOption();
+    parser.addOption({"clients", "Simulated viewers.", "count", "1000"});
+    parser.addOption({"slow", "Viewers that stop reading after connecting.", "count", "0"});
+    parser.addOption({"connect", "Use a running app's server instead of one in this process.", "host:port"});
+    parser.addOption({"events", "Elimination events published per reveal (in-process server only).", "count", "50"});
+    parser.addOption({"interval", "Milliseconds between published events.", "ms", "20"});
+    parser.addOption({"payload", "Extra bytes of padding in every event.", "bytes", "0"});
+    parser.addOption({"duration", "Seconds to listen when connecting to a running app.", "seconds", "60"});
+    parser.process(app);
+
+    raiseFileLimit();
+
+    int clients = parser.value("clients").toInt();
+    int slow = std::min(parser.value("slow").toInt(), clients);
+
+    // Without --connect the same server the app uses runs here, on its own thread
+    BroadcastServer server;
+    QString host = "127.0.0.1";
+    quint16 port = 0;
+    if (parser.isSet("connect"))
+    {
+        QStringList parts = parser.value("connect").split(':');
+        host = parts.value(0);
+        port = static_cast<quint16>(parts.value(1).toUInt());
+    }
+    else
+    {
+        QString error;
+        if (!server.start(0, error))
+        {
+            std::fprintf(stderr, "%s\n", qPrintable(error));
+            return 2;
+        }
+        port = server.port();
+    }
+
+    QThread swarmThread;
+    ViewerSwarm swarm;
+    swarm.moveToThread(&swarmThread);
+    swarmThread.start();
+    QMetaObject::invokeMethod(&swarm, [&swarm, host, port, clients, slow]()
+                              { swarm.connectViewers(host, port, clients, slow); });
+
+    // Wait for the handshakes, then publish like a reveal would
+    QElapsedTimer waited;
+    waited.start();
+    while (swarm.connected.loadRelaxed() + swarm.failed.loadRelaxed() < clients && waited.elapsed() < 30000)
+    {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+        QThread::msleep(10);
+    }
+    std::printf("clients        %d connected, %d failed in %lld ms\n", swarm.connected.loadRelaxed(), swarm.failed.loadRelaxed(),
+                waited.elapsed());
+
+    // Stands in for the reveal's frame clock, publishing must never delay it
+    QVector<qint64> lateness;
+    QElapsedTimer frameClock;
+    QTimer frameTimer;
+    frameTimer.setTimerType(Qt::PreciseTimer);
+    frameTimer.setInterval(16);
+    QObject::connect(&frameTimer, &QTimer::timeout, [&lateness, &frameClock]()
+                     {
+        lateness.append(std::max<qint64>(0, frameClock.restart() - 16)); });
+
+    int events = parser.value("events").toInt();
+    int published = 0;
+    QByteArray padding(parser.value("payload").toInt(), 'x');
+    QTimer publishTimer;
+    publishTimer.setInterval(parser.value("interval").toInt());
+    QObject::connect(&publishTimer, &QTimer::timeout, [&]()
+                     {
+        QJsonObject event;
+        if (published == 0)
+        {
+            event["type"] = "start";
+            event["teams"] = events + 1;
+        }
+        else if (published <= events)
+        {
+            event["type"] = "elimination";
+            event["team"] = QString("Team %1").arg(published);
+            event["odds"] = "1.00%";
+            event["pick"] = events + 2 - published;
+        }
+        else
+        {
+            event["type"] = "winner";
+            event["team"] = "Team 0";
+            event["odds"] = "25.00%";
+            event["pick"] = 1;
+            publishTimer.stop();
+        }
+        if (!padding.isEmpty())
+            event["padding"] = QString::fromLatin1(padding);
+
+        server.publish(event);
+        ++published; });
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    frameClock.start();
+    frameTimer.start();
+
+    qint64 listenFor;
+    if (parser.isSet("connect"))
+    {
+        listenFor = parser.value("duration").toLongLong() * 1000;
+    }
+    else
+    {
+        publishTimer.start();
+        listenFor = (events + 2) * publishTimer.interval() + 1000;
+    }
+    while (elapsed.elapsed() < listenFor)
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 50);
+    frameTimer.stop();
+
+    QMetaObject::invokeMethod(&swarm, [&swarm]()
+                              { swarm.disconnectViewers(); }, Qt::BlockingQueuedConnection);
+    swarmThread.quit();
+    swarmThread.wait();
+    server.stop();
+
+    QVector<qint64> latencies = swarm.takeLatencies();
+    int expected = published * (swarm.connected.loadRelaxed() - slow);
+    std::printf("messages       %d received", swarm.messages.loadRelaxed());
+    if (!parser.isSet("connect"))
+        std::printf(" of %d expected by reading viewers", expected);
+    std::printf("\ndropped        %d viewers disconnected by the server\n", swarm.dropped.loadRelaxed());
+    std::printf("latency ms     p50 %.0f  p99 %.0f  max %.0f\n", percentile(latencies, 0.5), percentile(latencies, 0.99),
+                percentile(latencies, 1.0));
+    std::printf("frame late ms  p99 %.0f  max %.0f\n", percentile(lateness, 0.99), percentile(lateness, 1.0));
+    return 0;
+}
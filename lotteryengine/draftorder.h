@@ -0,0 +1,53 @@
+#ifndef DRAFTORDER_H
+#define DRAFTORDER_H
+
+#include "lotteryengine.h"
+#include "uniformrandom.h"
+#include "weightedorder.h"
+
+#include <cstdint>
+#include <vector>
+
+// Draws one complete lottery, order[0] is the first overall pick.
+// With weightedOrder every pick is drawn by odds, otherwise only the first
+// pick is and the other teams follow in a uniformly shuffled order. Teams
+// without a positive weight are left out. Returns an empty order if no team
+// can be drawn.
+// Without weightedOrder only the alias table and integer draws are used, so
+// the same generator state gives the same order on every platform. The
+// weighted order compares std::log based keys, whose last bits may differ
+// between C libraries, so its replays are only exact with the same build.
+template <typename Rng>
+std::vector<int> drawDraftOrder(const std::vector<std::int64_t> &weights, bool weightedOrder, Rng &rng)
+{
+    std::vector<int> order;
+
+    if (weightedOrder)
+    {
+        WeightedOrderSampler sampler(weights);
+        sampler.draw(0, rng, order);
+        return order;
+    }
+
+    LotteryEngine engine(weights);
+    int winner = engine.draw(rng);
+    if (winner < 0)
+        return order;
+
+    order.push_back(winner);
+    for (std::size_t i = 0; i < weights.size(); ++i)
+    {
+        if (static_cast<int>(i) != winner && weights[i] > 0)
+            order.push_back(static_cast<int>(i));
+    }
+
+    // Fisher-Yates over everything after the winner
+    for (std::size_t i = order.size() - 1; i > 1; --i)
+    {
+        std::size_t j = 1 + static_cast<std::size_t>(uniformBelow(rng, static_cast<std::uint64_t>(i)));
+        std::swap(order[i], order[j]);
+    }
+    return order;
+}
+
+#endif // DRAFTORDER_H
@@ -0,0 +1,159 @@
+#include "dynamicsampler.h"
+
+#include <limits>
+
+DynamicSampler::DynamicSampler(const std::vector<std::int64_t> &weights)
+{
+    assign(weights);
+}
+
+bool DynamicSampler::assign(const std::vector<std::int64_t> &newWeights)
+{
+    weights.clear();
+    entries = 0;
+
+    if (newWeights.size() > static_cast<std::size_t>(std::numeric_limits<int>::max() - blockSize))
+    {
+        rebuild();
+        return false;
+    }
+
+    std::uint64_t sum = 0;
+    for (std::int64_t w : newWeights)
+    {
+        std::uint64_t value = w > 0 ? static_cast<std::uint64_t>(w) : 0;
+        if (sum > std::numeric_limits<std::uint64_t>::max() - value)
+        {
+            rebuild();
+            return false;
+        }
+        sum += value;
+    }
+
+    entries = newWeights.size();
+    weights.resize((entries + blockSize - 1) & ~static_cast<std::size_t>(blockSize - 1), 0);
+    for (std::size_t i = 0; i < entries; ++i)
+        weights[i] = newWeights[i] > 0 ? static_cast<std::uint64_t>(newWeights[i]) : 0;
+
+    rebuild();
+    return true;
+}
+
+int DynamicSampler::add(std::int64_t weight)
+{
+    std::uint64_t value = weight > 0 ? static_cast<std::uint64_t>(weight) : 0;
+    if (total > std::numeric_limits<std::uint64_t>::max() - value || entries >= static_cast<std::size_t>(std::numeric_limits<int>::max() - blockSize))
+        return -1;
+
+    int index = static_cast<int>(entries++);
+    if (entries > weights.size())
+    {
+        // A new block, its node covers (b - lowbit(b), b] and every block before b already has its node
+        weights.resize(weights.size() + blockSize, 0);
+        int block = blockCount() + 1;
+        int low = block - (block & -block);
+        std::uint64_t covered = 0;
+        for (int b = block - 1; b > low; b -= b & -b)
+            covered += tree[b];
+        tree.push_back(covered);
+        if (topStep * 2 <= block)
+            topStep *= 2;
+    }
+
+    weights[index] = value;
+    addToBlock(index >> blockShift, value);
+    total += value;
+    return index;
+}
+
+bool DynamicSampler::setWeight(int index, std::int64_t weight)
+{
+    std::uint64_t value = weight > 0 ? static_cast<std::uint64_t>(weight) : 0;
+    std::uint64_t old = weights[index];
+    if (value > old && total - old > std::numeric_limits<std::uint64_t>::max() - value)
+        return false;
+
+    // Unsigned wrap-around makes a decrease an addition modulo 2^64, which the sums undo exactly
+    weights[index] = value;
+    addToBlock(index >> blockShift, value - old);
+    total += value - old;
+    return true;
+}
+
+bool DynamicSampler::update(const std::vector<Update> &updates)
+{
+    // Rebuilding costs one pass over the blocks, walking the tree costs
+    // about log2(blocks) nodes per update
+    int depth = 1;
+    while ((1 << depth) < blockCount())
+        ++depth;
+    bool batched = updates.size() * static_cast<std::size_t>(depth) > static_cast<std::size_t>(blockCount());
+
+    std::uint64_t sum = total;
+    std::vector<std::uint64_t> previous;
+    previous.reserve(updates.size());
+    for (const Update &u : updates)
+    {
+        std::uint64_t value = u.weight > 0 ? static_cast<std::uint64_t>(u.weight) : 0;
+        previous.push_back(weights[u.index]);
+        sum -= weights[u.index];
+        if (sum > std::numeric_limits<std::uint64_t>::max() - value)
+        {
+            // Put back what was overwritten, last first so repeated indices end at their original weight
+            for (std::size_t i = previous.size() - 1; i-- > 0;)
+                weights[updates[i].index] = previous[i];
+            return false;
+        }
+        sum += value;
+        weights[u.index] = value;
+    }
+
+    if (batched)
+    {
+        rebuild();
+        return true;
+    }
+
+    // Weights are already in place, walk each change into the tree
+    for (std::size_t i = 0; i < updates.size(); ++i)
+    {
+        std::uint64_t value = updates[i].weight > 0 ? static_cast<std::uint64_t>(updates[i].weight) : 0;
+        addToBlock(updates[i].index >> blockShift, value - previous[i]);
+    }
+    total = sum;
+    return true;
+}
+
+void DynamicSampler::addToBlock(int block, std::uint64_t delta)
+{
+    const int blocks = blockCount();
+    for (int b = block + 1; b <= blocks; b += b & -b)
+        tree[b] += delta;
+}
+
+// Builds every node from the blocks in one pass, each node pushes its total to its parent
+void DynamicSampler::rebuild()
+{
+    const int blocks = static_cast<int>(weights.size() >> blockShift);
+    tree.assign(static_cast<std::size_t>(blocks) + 1, 0);
+    total = 0;
+
+    for (int b = 1; b <= blocks; ++b)
+    {
+        const std::uint64_t *entry = weights.data() + (static_cast<std::size_t>(b - 1) << blockShift);
+        std::uint64_t sum = 0;
+        for (int i = 0; i < blockSize; ++i)
+            sum += entry[i];
+        tree[b] += sum;
+        total += sum;
+
+        int parent = b + (b & -b);
+        if (parent <= blocks)
+            tree[parent] += tree[b];
+    }
+
+    // The largest power of two within the tree, where every descent starts
+    topStep = 1;
+    while (topStep * 2 <= blocks)
+        topStep *= 2;
+}
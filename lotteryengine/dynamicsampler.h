@@ -0,0 +1,111 @@
+#ifndef DYNAMICSAMPLER_H
+#define DYNAMICSAMPLER_H
+
+#include "uniformrandom.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Weighted draws from a pool whose entries are added, removed and
+// re-weighted between draws, for rolling raffles. The alias table would have
+// to be rebuilt in O(n) after every change; here a change and a draw are
+// both O(log n).
+// Entries are grouped in blocks of eight, one cache line of weights, and a
+// Fenwick tree holds the block totals. A draw walks down the tree to a block
+// and scans that one line, so the tree is an eighth of the pool's size and
+// three levels shallower than a tree over single entries.
+// Indices stay stable: a removed entry keeps its index with weight 0.
+class DynamicSampler
+{
+public:
+    struct Update
+    {
+        int index;
+        std::int64_t weight;
+    };
+
+    DynamicSampler() = default;
+    explicit DynamicSampler(const std::vector<std::int64_t> &weights);
+
+    // Replaces the whole pool in O(n), non-positive weights can never be drawn.
+    // Returns false (and leaves the pool empty) if the total does not fit 64 bits.
+    bool assign(const std::vector<std::int64_t> &weights);
+
+    // Appends an entry and returns its index, or -1 if the total would overflow
+    int add(std::int64_t weight);
+
+    // Returns false if the new total would overflow, the weight is then unchanged
+    bool setWeight(int index, std::int64_t weight);
+    void remove(int index) { setWeight(index, 0); }
+
+    // Applies every update in order. Large batches rebuild the tree once
+    // instead of walking it per update. Returns false if the total would
+    // overflow, in which case no update is applied.
+    bool update(const std::vector<Update> &updates);
+
+    int size() const { return static_cast<int>(entries); }
+    std::int64_t weight(int index) const { return static_cast<std::int64_t>(weights[index]); }
+    std::uint64_t totalWeight() const { return total; }
+    bool isValid() const { return total > 0; }
+
+    // Draws a single index, or -1 if no entry has weight
+    template <typename Rng>
+    int draw(Rng &rng) const
+    {
+        if (!isValid())
+            return -1;
+        return find(uniformBelow(rng, total));
+    }
+
+    // Fills out[0..count) with independent draws
+    template <typename Rng>
+    void drawBatch(int *out, std::size_t count, Rng &rng) const
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] = isValid() ? find(uniformBelow(rng, total)) : -1;
+    }
+
+private:
+    static const int blockShift = 3;
+    static const int blockSize = 1 << blockShift;
+
+    int blockCount() const { return static_cast<int>(tree.size()) - 1; }
+
+    // The entry owning unit `target` of the total
+    int find(std::uint64_t target) const
+    {
+        // Fenwick descent: take every step whose whole range lies below the target
+        int block = 0;
+        const int blocks = blockCount();
+        const std::uint64_t *nodes = tree.data();
+        for (int step = topStep; step > 0; step >>= 1)
+        {
+            int next = block + step;
+            if (next <= blocks && nodes[next] <= target)
+            {
+                block = next;
+                target -= nodes[next];
+            }
+        }
+
+        const std::uint64_t *entry = weights.data() + (static_cast<std::size_t>(block) << blockShift);
+        int offset = 0;
+        while (target >= entry[offset])
+            target -= entry[offset++];
+        return (block << blockShift) + offset;
+    }
+
+    void addToBlock(int block, std::uint64_t delta);
+    void rebuild();
+
+    // Rounded up to whole blocks, the padding entries have weight 0
+    std::vector<std::uint64_t> weights;
+    // tree[b] is the total of blocks (b - lowbit(b), b], tree[0] is unused
+    std::vector<std::uint64_t> tree = std::vector<std::uint64_t>(1, 0);
+    std::size_t entries = 0;
+    std::uint64_t total = 0;
+    int topStep = 1;
+};
+
+#endif // DYNAMICSAMPLER_H
@@ -0,0 +1,293 @@
+#include "entryfile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+namespace
+{
+    const char indexMagic[8] = {'D', 'L', 'E', 'N', 'T', 'I', 'D', 'X'};
+    const std::uint32_t indexVersion = 2;
+
+    // Arrays follow in the order offsets, weights, lengths so each stays aligned
+    struct IndexHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+        std::uint64_t count;
+        std::uint64_t skipped;
+        std::uint64_t sourceSize;
+        std::uint64_t fingerprint;
+    };
+
+    // Chunks smaller than this are not worth a thread
+    const std::size_t minimumChunk = std::size_t(1) << 20;
+
+    // Digits in the largest weight that cannot overflow
+    const int maximumWeightDigits = 18;
+
+    bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+}
+
+EntryFile::~EntryFile()
+{
+    close();
+}
+
+bool EntryFile::open(const std::string &path, const std::string &indexPath, unsigned threads)
+{
+    close();
+
+    if (!source.map(path, error))
+        return false;
+
+    if (!indexPath.empty() && loadIndex(indexPath))
+        return true;
+
+    parse(threads);
+    return true;
+}
+
+void EntryFile::close()
+{
+    source.unmap();
+    index.unmap();
+
+    parsedOffsets = std::vector<std::uint64_t>();
+    parsedLengths = std::vector<std::uint32_t>();
+    parsedWeights = std::vector<std::int64_t>();
+
+    nameOffsets = nullptr;
+    nameLengths = nullptr;
+    entryWeights = nullptr;
+    count = 0;
+    skipped = 0;
+    error.clear();
+}
+
+std::vector<std::int64_t> EntryFile::weights() const
+{
+    return std::vector<std::int64_t>(entryWeights, entryWeights + count);
+}
+
+// Splits the file at line boundaries and parses the pieces in parallel
+void EntryFile::parse(unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(1, source.size / minimumChunk)));
+
+    std::vector<std::size_t> bounds(1, 0);
+    for (unsigned t = 1; t < threads; ++t)
+    {
+        std::size_t at = std::max(bounds.back(), source.size / threads * t);
+        const void *newline = std::memchr(source.data + at, '\n', source.size - at);
+        at = newline ? static_cast<const char *>(newline) - source.data + 1 : source.size;
+        bounds.push_back(at);
+    }
+    bounds.push_back(source.size);
+
+    std::vector<Chunk> chunks(threads);
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t)
+        workers.emplace_back(&EntryFile::parseRange, this, bounds[t], bounds[t + 1], std::ref(chunks[t]));
+    parseRange(bounds[0], bounds[1], chunks[0]);
+    for (std::thread &worker : workers)
+        worker.join();
+
+    if (threads == 1)
+    {
+        parsedOffsets.swap(chunks[0].offsets);
+        parsedLengths.swap(chunks[0].lengths);
+        parsedWeights.swap(chunks[0].weights);
+        skipped = chunks[0].skipped;
+    }
+    else
+    {
+        std::size_t total = 0;
+        for (const Chunk &chunk : chunks)
+            total += chunk.offsets.size();
+
+        parsedOffsets.reserve(total);
+        parsedLengths.reserve(total);
+        parsedWeights.reserve(total);
+
+        // Each chunk is freed as soon as it is copied, so peak memory only grows by one chunk
+        for (Chunk &chunk : chunks)
+        {
+            parsedOffsets.insert(parsedOffsets.end(), chunk.offsets.begin(), chunk.offsets.end());
+            parsedLengths.insert(parsedLengths.end(), chunk.lengths.begin(), chunk.lengths.end());
+            parsedWeights.insert(parsedWeights.end(), chunk.weights.begin(), chunk.weights.end());
+            skipped += chunk.skipped;
+            chunk = Chunk();
+        }
+    }
+
+    nameOffsets = parsedOffsets.data();
+    nameLengths = parsedLengths.data();
+    entryWeights = parsedWeights.data();
+    count = parsedWeights.size();
+}
+
+// Parses the lines in [begin, end). Newlines are found with memchr, which the
+// C library implements with SIMD, and the weight is read back from the line end.
+void EntryFile::parseRange(std::size_t begin, std::size_t end, Chunk &chunk) const
+{
+    const char *data = source.data;
+
+    // Rough guess of 24 bytes per line saves most reallocations
+    std::size_t expected = (end - begin) / 24;
+    chunk.offsets.reserve(expected);
+    chunk.lengths.reserve(expected);
+    chunk.weights.reserve(expected);
+
+    std::size_t lineStart = begin;
+    while (lineStart < end)
+    {
+        const void *newline = std::memchr(data + lineStart, '\n', end - lineStart);
+        std::size_t lineEnd = newline ? static_cast<const char *>(newline) - data : end;
+        std::size_t next = lineEnd + 1;
+
+        while (lineEnd > lineStart && isBlank(data[lineEnd - 1]))
+            --lineEnd;
+
+        if (lineEnd == lineStart)
+        {
+            lineStart = next;
+            continue;
+        }
+
+        // Weight digits run back from the end of the line to the last comma
+        std::size_t digitsStart = lineEnd;
+        while (digitsStart > lineStart && data[digitsStart - 1] >= '0' && data[digitsStart - 1] <= '9')
+            --digitsStart;
+
+        std::size_t comma = digitsStart;
+        while (comma > lineStart && isBlank(data[comma - 1]))
+            --comma;
+
+        int digits = static_cast<int>(lineEnd - digitsStart);
+        if (digits == 0 || digits > maximumWeightDigits || comma == lineStart || data[comma - 1] != ',')
+        {
+            // Headers and anything else without a whole number weight
+            ++chunk.skipped;
+            lineStart = next;
+            continue;
+        }
+
+        std::int64_t weight = 0;
+        for (std::size_t i = digitsStart; i < lineEnd; ++i)
+            weight = weight * 10 + (data[i] - '0');
+
+        std::size_t nameStart = lineStart;
+        std::size_t nameEnd = comma - 1;
+        while (nameStart < nameEnd && isBlank(data[nameStart]))
+            ++nameStart;
+        while (nameEnd > nameStart && isBlank(data[nameEnd - 1]))
+            --nameEnd;
+
+        chunk.offsets.push_back(nameStart);
+        chunk.lengths.push_back(static_cast<std::uint32_t>(nameEnd - nameStart));
+        chunk.weights.push_back(weight);
+        lineStart = next;
+    }
+}
+
+// Hash of the whole file, so an index goes stale with any edit, even one
+// that keeps the size. Four independent lanes of 8-byte words keep the
+// multiplies pipelined, which hashes far faster than the parser reads.
+std::uint64_t EntryFile::fingerprint() const
+{
+    const std::uint64_t prime = 0x9e3779b97f4a7c15ull;
+    std::uint64_t lanes[4] = {source.size, prime, ~source.size, ~prime};
+
+    auto mix = [prime](std::uint64_t lane, std::uint64_t word)
+    {
+        lane ^= word;
+        lane *= prime;
+        return lane ^ (lane >> 29);
+    };
+
+    const std::size_t block = 4 * sizeof(std::uint64_t);
+    std::size_t offset = 0;
+    for (; offset + block <= source.size; offset += block)
+    {
+        std::uint64_t words[4];
+        std::memcpy(words, source.data + offset, block);
+        for (int lane = 0; lane < 4; ++lane)
+            lanes[lane] = mix(lanes[lane], words[lane]);
+    }
+
+    // The tail, zero padded
+    std::uint64_t tail[4] = {};
+    std::memcpy(tail, source.data + offset, source.size - offset);
+    for (int lane = 0; lane < 4; ++lane)
+        lanes[lane] = mix(lanes[lane], tail[lane]);
+
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::uint64_t lane : lanes)
+        hash = mix(hash, lane);
+    return hash;
+}
+
+bool EntryFile::loadIndex(const std::string &indexPath)
+{
+    // A missing or stale index is not an error, the file is parsed instead
+    std::string ignored;
+    if (!index.map(indexPath, ignored))
+        return false;
+
+    IndexHeader header;
+    if (index.size < sizeof(header))
+    {
+        index.unmap();
+        return false;
+    }
+    std::memcpy(&header, index.data, sizeof(header));
+
+    std::size_t expected = sizeof(header) + header.count * (sizeof(std::uint64_t) + sizeof(std::int64_t) + sizeof(std::uint32_t));
+    if (std::memcmp(header.magic, indexMagic, sizeof(indexMagic)) != 0 || header.version != indexVersion ||
+        header.sourceSize != source.size || header.fingerprint != fingerprint() || index.size != expected)
+    {
+        index.unmap();
+        return false;
+    }
+
+    const char *arrays = index.data + sizeof(header);
+    count = static_cast<std::size_t>(header.count);
+    skipped = header.skipped;
+    nameOffsets = reinterpret_cast<const std::uint64_t *>(arrays);
+    entryWeights = reinterpret_cast<const std::int64_t *>(arrays + count * sizeof(std::uint64_t));
+    nameLengths = reinterpret_cast<const std::uint32_t *>(arrays + count * (sizeof(std::uint64_t) + sizeof(std::int64_t)));
+    return true;
+}
+
+bool EntryFile::writeIndex(const std::string &indexPath) const
+{
+    if (!isOpen())
+        return false;
+
+    std::FILE *file = std::fopen(indexPath.c_str(), "wb");
+    if (!file)
+        return false;
+
+    IndexHeader header = {};
+    std::memcpy(header.magic, indexMagic, sizeof(indexMagic));
+    header.version = indexVersion;
+    header.count = count;
+    header.skipped = skipped;
+    header.sourceSize = source.size;
+    header.fingerprint = fingerprint();
+
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   std::fwrite(nameOffsets, sizeof(std::uint64_t), count, file) == count &&
+                   std::fwrite(entryWeights, sizeof(std::int64_t), count, file) == count &&
+                   std::fwrite(nameLengths, sizeof(std::uint32_t), count, file) == count;
+    return std::fclose(file) == 0 && written;
+}
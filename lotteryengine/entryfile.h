@@ -0,0 +1,85 @@
+#ifndef ENTRYFILE_H
+#define ENTRYFILE_H
+
+#include "mappedfile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read-only view of a large "name,weight" entry file.
+// The file is memory-mapped and parsed in place: names are string views into
+// the mapping and only an offset, a length and a weight are kept per entry,
+// so a file with tens of millions of lines costs little more than its own
+// size. Chunks of the file are parsed on several threads.
+// A compact binary index can be written next to the file; when it matches
+// the file, opening maps the index as well and skips parsing entirely.
+class EntryFile
+{
+public:
+    EntryFile() = default;
+    ~EntryFile();
+
+    EntryFile(const EntryFile &) = delete;
+    EntryFile &operator=(const EntryFile &) = delete;
+
+    // Maps the file and loads `indexPath` if it is a valid index for it,
+    // otherwise parses the file. Lines without a numeric weight are skipped.
+    bool open(const std::string &path, const std::string &indexPath = std::string(), unsigned threads = 0);
+    void close();
+
+    // Writes the parsed entries so the next open() can skip parsing
+    bool writeIndex(const std::string &indexPath) const;
+
+    bool isOpen() const { return source.data != nullptr; }
+    bool loadedFromIndex() const { return index.data != nullptr; }
+    const std::string &errorString() const { return error; }
+
+    std::size_t size() const { return count; }
+    std::uint64_t skippedLines() const { return skipped; }
+
+    std::string_view name(std::size_t entry) const
+    {
+        return std::string_view(source.data + nameOffsets[entry], nameLengths[entry]);
+    }
+    std::int64_t weight(std::size_t entry) const { return entryWeights[entry]; }
+
+    // Copy of every weight, in the form the samplers take
+    std::vector<std::int64_t> weights() const;
+
+    // The weights in place, size() of them, in the mapped index when there is one
+    const std::int64_t *weightData() const { return entryWeights; }
+
+private:
+    struct Chunk
+    {
+        std::vector<std::uint64_t> offsets;
+        std::vector<std::uint32_t> lengths;
+        std::vector<std::int64_t> weights;
+        std::uint64_t skipped = 0;
+    };
+
+    void parse(unsigned threads);
+    void parseRange(std::size_t begin, std::size_t end, Chunk &chunk) const;
+    bool loadIndex(const std::string &indexPath);
+    std::uint64_t fingerprint() const;
+
+    MappedFile source;
+    MappedFile index;
+
+    // Filled when parsing, empty when the arrays live in the mapped index
+    std::vector<std::uint64_t> parsedOffsets;
+    std::vector<std::uint32_t> parsedLengths;
+    std::vector<std::int64_t> parsedWeights;
+
+    const std::uint64_t *nameOffsets = nullptr;
+    const std::uint32_t *nameLengths = nullptr;
+    const std::int64_t *entryWeights = nullptr;
+    std::size_t count = 0;
+    std::uint64_t skipped = 0;
+    std::string error;
+};
+
+#endif // ENTRYFILE_H
@@ -0,0 +1,222 @@
+#include "exactpickodds.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // Levels smaller than this are not worth handing to other threads
+    const std::size_t parallelThreshold = 4096;
+
+    // a * b / d rounded to nearest, the result must fit in 64 bits
+    std::uint64_t mulDiv(std::uint64_t a, std::uint64_t b, std::uint64_t d)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        std::uint64_t high;
+        std::uint64_t low = _umul128(a, b, &high);
+        std::uint64_t half = d / 2;
+        low += half;
+        if (low < half)
+            ++high;
+        std::uint64_t remainder;
+        return _udiv128(high, low, d, &remainder);
+#else
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b + d / 2;
+        return static_cast<std::uint64_t>(product / d);
+#endif
+    }
+
+    // A set of teams already drawn and the chance of drawing exactly that set first
+    struct State
+    {
+        std::uint64_t mask;
+        std::uint64_t probability;
+        std::uint64_t removed;
+    };
+
+    // Draws one more team from every state in [begin, end), accumulating
+    // results[bit * picks + level] and, unless this is the last level, the successor states
+    void expand(const State *begin, const State *end, const std::vector<std::uint64_t> &weights, std::uint64_t total,
+                int level, int picks, std::uint64_t *results, std::vector<State> *next)
+    {
+        const int m = static_cast<int>(weights.size());
+
+        for (const State *state = begin; state != end; ++state)
+        {
+            const std::uint64_t remaining = total - state->removed;
+
+            for (int bit = 0; bit < m; ++bit)
+            {
+                const std::uint64_t flag = std::uint64_t(1) << bit;
+                if (state->mask & flag)
+                    continue;
+
+                std::uint64_t q = mulDiv(state->probability, weights[bit], remaining);
+                results[static_cast<std::size_t>(bit) * picks + level] += q;
+
+                if (next && q)
+                    next->push_back({state->mask | flag, q, state->removed + weights[bit]});
+            }
+        }
+    }
+
+    // Sums the probability of states that reached the same set through different orders
+    void mergeStates(std::vector<State> &states)
+    {
+        std::sort(states.begin(), states.end(), [](const State &a, const State &b)
+                  { return a.mask < b.mask; });
+
+        std::size_t out = 0;
+        for (std::size_t i = 0; i < states.size(); ++i)
+        {
+            if (out > 0 && states[out - 1].mask == states[i].mask)
+                states[out - 1].probability += states[i].probability;
+            else
+                states[out++] = states[i];
+        }
+        states.resize(out);
+    }
+}
+
+ExactPickOdds ExactPickOdds::weightedOrder(const std::vector<std::int64_t> &weights, int picks, unsigned threads)
+{
+    ExactPickOdds result;
+
+    // Only teams that can be drawn get a bit in the subset mask
+    std::vector<std::uint64_t> eligibleWeights;
+    std::vector<int> eligibleTeams;
+    std::uint64_t total = 0;
+
+    for (std::size_t i = 0; i < weights.size(); ++i)
+    {
+        if (weights[i] > 0)
+        {
+            eligibleWeights.push_back(static_cast<std::uint64_t>(weights[i]));
+            eligibleTeams.push_back(static_cast<int>(i));
+            total += static_cast<std::uint64_t>(weights[i]);
+        }
+    }
+
+    const int m = static_cast<int>(eligibleWeights.size());
+    if (m == 0 || m > 64 || picks <= 0)
+        return result;
+
+    picks = std::min(picks, m);
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::uint64_t> bitResults(static_cast<std::size_t>(m) * picks, 0);
+    std::vector<State> level{{0, One, 0}};
+
+    for (int depth = 0; depth < picks; ++depth)
+    {
+        const bool last = depth + 1 == picks;
+        std::vector<State> next;
+
+        if (level.size() < parallelThreshold || threads == 1)
+        {
+            expand(level.data(), level.data() + level.size(), eligibleWeights, total, depth, picks,
+                   bitResults.data(), last ? nullptr : &next);
+        }
+        else
+        {
+            // Every state in a level is independent, so each worker takes a slice
+            // with its own result and successor buffers
+            const unsigned workers = static_cast<unsigned>(std::min<std::size_t>(threads, level.size()));
+            std::vector<std::vector<std::uint64_t>> partialResults(workers, std::vector<std::uint64_t>(bitResults.size(), 0));
+            std::vector<std::vector<State>> partialNext(workers);
+            std::vector<std::thread> pool;
+
+            for (unsigned w = 0; w < workers; ++w)
+            {
+                const State *begin = level.data() + level.size() * w / workers;
+                const State *end = level.data() + level.size() * (w + 1) / workers;
+                pool.emplace_back(expand, begin, end, std::cref(eligibleWeights), total, depth, picks,
+                                  partialResults[w].data(), last ? nullptr : &partialNext[w]);
+            }
+            for (std::thread &worker : pool)
+                worker.join();
+
+            // Integer sums are exact, so the merge order does not change the result
+            for (unsigned w = 0; w < workers; ++w)
+            {
+                for (std::size_t i = 0; i < bitResults.size(); ++i)
+                    bitResults[i] += partialResults[w][i];
+                next.insert(next.end(), partialNext[w].begin(), partialNext[w].end());
+            }
+        }
+
+        if (!last)
+        {
+            mergeStates(next);
+            level.swap(next);
+        }
+    }
+
+    result.teamCount = static_cast<int>(weights.size());
+    result.pickCount = picks;
+    result.odds.assign(static_cast<std::size_t>(result.teamCount) * picks, 0);
+
+    for (int bit = 0; bit < m; ++bit)
+    {
+        for (int pick = 0; pick < picks; ++pick)
+            result.odds[static_cast<std::size_t>(eligibleTeams[bit]) * picks + pick] = bitResults[static_cast<std::size_t>(bit) * picks + pick];
+    }
+
+    return result;
+}
+
+ExactPickOdds ExactPickOdds::winnerThenShuffle(const std::vector<std::int64_t> &weights, int picks)
+{
+    ExactPickOdds result;
+
+    std::uint64_t total = 0;
+    int eligible = 0;
+    for (std::int64_t w : weights)
+    {
+        if (w > 0)
+        {
+            total += static_cast<std::uint64_t>(w);
+            ++eligible;
+        }
+    }
+
+    if (eligible == 0 || picks <= 0)
+        return result;
+
+    picks = std::min(picks, eligible);
+
+    result.teamCount = static_cast<int>(weights.size());
+    result.pickCount = picks;
+    result.odds.assign(static_cast<std::size_t>(result.teamCount) * picks, 0);
+
+    for (int team = 0; team < result.teamCount; ++team)
+    {
+        if (weights[team] <= 0)
+            continue;
+
+        // Everyone who did not win is equally likely to land in any later slot
+        std::uint64_t first = mulDiv(One, static_cast<std::uint64_t>(weights[team]), total);
+        std::uint64_t later = eligible > 1 ? (One - first) / static_cast<std::uint64_t>(eligible - 1) : 0;
+
+        result.odds[static_cast<std::size_t>(team) * picks] = first;
+        for (int pick = 1; pick < picks; ++pick)
+            result.odds[static_cast<std::size_t>(team) * picks + pick] = later;
+    }
+
+    return result;
+}
+
+double ExactPickOdds::topPicksProbability(int team) const
+{
+    std::uint64_t sum = 0;
+    for (int pick = 0; pick < pickCount; ++pick)
+        sum += fixedPoint(team, pick);
+    return static_cast<double>(sum) / One;
+}
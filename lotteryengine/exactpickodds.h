@@ -0,0 +1,46 @@
+#ifndef EXACTPICKODDS_H
+#define EXACTPICKODDS_H
+
+#include <cstdint>
+#include <vector>
+
+// Exact odds of every team landing at each of the first k picks.
+// Probabilities are unsigned fixed-point with 63 fractional bits, so
+// One == 100%. Every intermediate sum is exact integer addition and each
+// conditional probability is rounded once, leaving an error of a few units
+// in the last place rather than sampling noise.
+class ExactPickOdds
+{
+public:
+    static constexpr std::uint64_t One = std::uint64_t(1) << 63;
+
+    // Every pick drawn by odds from the teams still in the pool.
+    // A subset dynamic program: the chance of reaching a set of already drawn
+    // teams does not depend on the order they were drawn in, so each subset is
+    // evaluated once per level instead of once per ordering. Only levels below
+    // `picks` are expanded and large levels are split across threads.
+    // Supports up to 64 teams with a positive weight.
+    static ExactPickOdds weightedOrder(const std::vector<std::int64_t> &weights, int picks, unsigned threads = 0);
+
+    // The app's default format: the first pick by odds, the rest uniformly at random
+    static ExactPickOdds winnerThenShuffle(const std::vector<std::int64_t> &weights, int picks);
+
+    bool isValid() const { return pickCount > 0; }
+    int teams() const { return teamCount; }
+    int picks() const { return pickCount; }
+
+    std::uint64_t fixedPoint(int team, int pick) const { return odds[static_cast<std::size_t>(team) * pickCount + pick]; }
+    double probability(int team, int pick) const { return static_cast<double>(fixedPoint(team, pick)) / One; }
+
+    // Chance of landing anywhere in the first `picks` picks
+    double topPicksProbability(int team) const;
+
+private:
+    int teamCount = 0;
+    int pickCount = 0;
+
+    // odds[team * pickCount + pick]
+    std::vector<std::uint64_t> odds;
+};
+
+#endif // EXACTPICKODDS_H
@@ -0,0 +1,463 @@
+#include "historystore.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const char historyMagic[8] = {'D', 'L', 'H', 'I', 'S', 'T', 'R', 'Y'};
+    const std::uint32_t historyVersion = 1;
+
+    struct FileHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+    };
+
+    enum RecordType : std::uint32_t
+    {
+        NameRecord = 1,
+        RunRecord = 2
+    };
+
+    // Every record starts 8-byte aligned and its size counts this header and the padding
+    struct RecordHeader
+    {
+        std::uint32_t type;
+        std::uint32_t size;
+    };
+
+    struct NameHeader
+    {
+        std::uint32_t id;
+        std::uint32_t length;
+    };
+
+    // Followed by the columns: name ids, odds and picks, one entry per team each
+    struct RunHeader
+    {
+        std::int64_t timestamp;
+        std::uint64_t seed;
+        std::uint64_t draw;
+        std::uint64_t oddsHash;
+        std::uint32_t format;
+        std::uint16_t teams;
+        std::uint8_t flags;
+        std::uint8_t winner;
+    };
+
+    const std::uint8_t weightedOrderFlag = 1;
+
+    const std::size_t runColumns = sizeof(RecordHeader) + sizeof(RunHeader);
+
+    std::uint32_t padded(std::size_t size)
+    {
+        return static_cast<std::uint32_t>((size + 7) & ~std::size_t(7));
+    }
+
+    std::uint32_t runSize(int teams)
+    {
+        return padded(runColumns + static_cast<std::size_t>(teams) * (sizeof(std::uint32_t) + sizeof(std::int32_t) + 1));
+    }
+
+    // FNV-1a of the odds column, only a hint: groups still compare the odds themselves
+    std::uint64_t oddsHash(const std::int32_t *odds, int teams)
+    {
+        std::uint64_t hash = 14695981039346656037ull ^ static_cast<std::uint64_t>(teams);
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(odds);
+        for (std::size_t i = 0; i < teams * sizeof(std::int32_t); ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool truncateFile(const std::string &path, std::uint64_t size)
+    {
+#ifdef _WIN32
+        int descriptor = _open(path.c_str(), _O_RDWR | _O_BINARY);
+        if (descriptor < 0)
+            return false;
+        bool truncated = _chsize_s(descriptor, static_cast<__int64>(size)) == 0;
+        _close(descriptor);
+        return truncated;
+#else
+        return ::truncate(path.c_str(), static_cast<off_t>(size)) == 0;
+#endif
+    }
+}
+
+HistoryStore::~HistoryStore()
+{
+    close();
+}
+
+bool HistoryStore::open(const std::string &logPath)
+{
+    close();
+    path = logPath;
+
+    // Only a missing or empty log is started with just the header, a log that
+    // can't be read or mapped is reported rather than overwritten
+    bool exists = true;
+    if (std::FILE *existing = std::fopen(path.c_str(), "rb"))
+        std::fclose(existing);
+    else if (errno == ENOENT)
+        exists = false;
+    else
+    {
+        error = "Could not open " + path;
+        return false;
+    }
+
+    if (exists && !mapping.map(path, error))
+        return false;
+
+    if (!exists || mapping.size == 0)
+    {
+        mapping.unmap();
+
+        FileHeader header = {};
+        std::memcpy(header.magic, historyMagic, sizeof(historyMagic));
+        header.version = historyVersion;
+
+        std::FILE *created = std::fopen(path.c_str(), "wb");
+        bool written = created && std::fwrite(&header, sizeof(header), 1, created) == 1;
+        if (!created || std::fclose(created) != 0 || !written)
+        {
+            error = "Could not create " + path;
+            return false;
+        }
+
+        if (!mapping.map(path, error))
+            return false;
+    }
+
+    if (!scan())
+    {
+        mapping.unmap();
+        return false;
+    }
+
+    // A run cut short by a crash would hide every run appended after it
+    if (end < mapping.size)
+    {
+        mapping.unmap();
+        if (!truncateFile(path, end))
+        {
+            error = "Could not drop the incomplete last run of " + path;
+            return false;
+        }
+    }
+
+    file = std::fopen(path.c_str(), "ab");
+    if (!file)
+    {
+        error = "Could not open " + path + " for writing";
+        mapping.unmap();
+        return false;
+    }
+    return true;
+}
+
+void HistoryStore::close()
+{
+    if (file)
+        std::fclose(file);
+    file = nullptr;
+    mapping.unmap();
+
+    path.clear();
+    end = 0;
+    runs = 0;
+    names.clear();
+    nameIds.clear();
+    error.clear();
+}
+
+// Reads the name records and counts the runs, stopping at the first record that does not fit
+bool HistoryStore::scan()
+{
+    FileHeader header;
+    if (mapping.size < sizeof(header))
+    {
+        error = path + " is not a lottery history";
+        return false;
+    }
+    std::memcpy(&header, mapping.data, sizeof(header));
+    if (std::memcmp(header.magic, historyMagic, sizeof(historyMagic)) != 0 || header.version != historyVersion)
+    {
+        error = path + " is not a lottery history";
+        return false;
+    }
+
+    std::uint64_t offset = sizeof(header);
+    while (offset + sizeof(RecordHeader) <= mapping.size)
+    {
+        const char *record = mapping.data + offset;
+        const RecordHeader *recordHeader = reinterpret_cast<const RecordHeader *>(record);
+        if (recordHeader->size < sizeof(RecordHeader) || recordHeader->size % 8 != 0 || recordHeader->size > mapping.size - offset)
+            break;
+
+        if (recordHeader->type == NameRecord)
+        {
+            const NameHeader *name = reinterpret_cast<const NameHeader *>(record + sizeof(RecordHeader));
+            if (recordHeader->size < sizeof(RecordHeader) + sizeof(NameHeader) || name->id != names.size() ||
+                recordHeader->size != padded(sizeof(RecordHeader) + sizeof(NameHeader) + name->length))
+                break;
+
+            names.emplace_back(reinterpret_cast<const char *>(name + 1), name->length);
+            nameIds.emplace(names.back(), name->id);
+        }
+        else if (recordHeader->type == RunRecord)
+        {
+            const RunHeader *run = reinterpret_cast<const RunHeader *>(record + sizeof(RecordHeader));
+            if (recordHeader->size < runColumns || run->teams == 0 || run->teams > maxTeams ||
+                recordHeader->size != runSize(run->teams) || run->winner >= run->teams)
+                break;
+            ++runs;
+        }
+
+        // Records of a later version's types are skipped
+        offset += recordHeader->size;
+    }
+
+    end = offset;
+    return true;
+}
+
+// Maps whatever was appended since the last query
+bool HistoryStore::refresh() const
+{
+    if (mapping.data && mapping.size >= end)
+        return true;
+
+    std::string ignored;
+    mapping.unmap();
+    return mapping.map(path, ignored) && mapping.size >= end;
+}
+
+std::uint32_t HistoryStore::intern(const std::string &name)
+{
+    auto found = nameIds.find(name);
+    if (found != nameIds.end())
+        return found->second;
+
+    std::uint32_t size = padded(sizeof(RecordHeader) + sizeof(NameHeader) + name.size());
+    std::vector<char> record(size, 0);
+    RecordHeader header = {NameRecord, size};
+    NameHeader nameHeader = {static_cast<std::uint32_t>(names.size()), static_cast<std::uint32_t>(name.size())};
+    std::memcpy(record.data(), &header, sizeof(header));
+    std::memcpy(record.data() + sizeof(header), &nameHeader, sizeof(nameHeader));
+    std::memcpy(record.data() + sizeof(header) + sizeof(nameHeader), name.data(), name.size());
+
+    if (std::fwrite(record.data(), 1, size, file) != size)
+        return noName;
+
+    end += size;
+    names.push_back(name);
+    nameIds.emplace(name, nameHeader.id);
+    return nameHeader.id;
+}
+
+bool HistoryStore::append(const Run &run)
+{
+    if (!file)
+    {
+        error = "The history is not open";
+        return false;
+    }
+
+    const int teams = static_cast<int>(run.names.size());
+    if (teams == 0 || teams > maxTeams || run.odds.size() != run.names.size() || run.order.size() != run.names.size())
+    {
+        error = "A run needs between 1 and 256 teams, each with odds and a pick";
+        return false;
+    }
+
+    std::uint32_t size = runSize(teams);
+    std::vector<char> record(size, 0);
+    std::uint32_t *nameColumn = reinterpret_cast<std::uint32_t *>(record.data() + runColumns);
+    std::int32_t *oddsColumn = reinterpret_cast<std::int32_t *>(nameColumn + teams);
+    std::uint8_t *pickColumn = reinterpret_cast<std::uint8_t *>(oddsColumn + teams);
+
+    // Every team has to get exactly one pick
+    std::vector<bool> picked(teams, false);
+    for (int pick = 0; pick < teams; ++pick)
+    {
+        int team = run.order[pick];
+        if (team < 0 || team >= teams || picked[team])
+        {
+            error = "The draft order of a run has to list every team once";
+            return false;
+        }
+        picked[team] = true;
+        pickColumn[team] = static_cast<std::uint8_t>(pick);
+    }
+
+    // New names go out as their own records ahead of the run
+    for (int team = 0; team < teams; ++team)
+    {
+        nameColumn[team] = intern(run.names[team]);
+        oddsColumn[team] = run.odds[team];
+    }
+    RunHeader header = {};
+    header.format = run.format.empty() ? noName : intern(run.format);
+    if (std::find(nameColumn, nameColumn + teams, noName) != nameColumn + teams || (!run.format.empty() && header.format == noName))
+    {
+        error = "Could not write to " + path;
+        return false;
+    }
+
+    header.timestamp = run.timestamp;
+    header.seed = run.seed;
+    header.draw = run.draw;
+    header.oddsHash = oddsHash(oddsColumn, teams);
+    header.teams = static_cast<std::uint16_t>(teams);
+    header.flags = run.weightedOrder ? weightedOrderFlag : 0;
+    header.winner = static_cast<std::uint8_t>(run.order.front());
+
+    RecordHeader recordHeader = {RunRecord, size};
+    std::memcpy(record.data(), &recordHeader, sizeof(recordHeader));
+    std::memcpy(record.data() + sizeof(recordHeader), &header, sizeof(header));
+
+    // Flushed so the next query's mapping sees the run
+    if (std::fwrite(record.data(), 1, size, file) != size || std::fflush(file) != 0)
+    {
+        error = "Could not write to " + path;
+        return false;
+    }
+
+    end += size;
+    ++runs;
+    return true;
+}
+
+const std::string &HistoryStore::name(std::uint32_t id) const
+{
+    static const std::string unknown;
+    return id < names.size() ? names[id] : unknown;
+}
+
+bool HistoryStore::nextRun(std::uint64_t &offset, RunView &run) const
+{
+    if (!refresh())
+        return false;
+
+    if (offset < sizeof(FileHeader))
+        offset = sizeof(FileHeader);
+
+    // Only records checked by scan() or written by append() are read
+    while (offset + sizeof(RecordHeader) <= end)
+    {
+        const char *record = mapping.data + offset;
+        const RecordHeader *recordHeader = reinterpret_cast<const RecordHeader *>(record);
+        offset += recordHeader->size;
+        if (recordHeader->type != RunRecord)
+            continue;
+
+        const RunHeader *header = reinterpret_cast<const RunHeader *>(record + sizeof(RecordHeader));
+        run.timestamp = header->timestamp;
+        run.seed = header->seed;
+        run.draw = header->draw;
+        run.weightedOrder = (header->flags & weightedOrderFlag) != 0;
+        run.format = header->format;
+        run.oddsHash = header->oddsHash;
+        run.teams = header->teams;
+        run.winner = header->winner;
+        run.names = reinterpret_cast<const std::uint32_t *>(record + runColumns);
+        run.odds = reinterpret_cast<const std::int32_t *>(run.names + run.teams);
+        run.picks = reinterpret_cast<const std::uint8_t *>(run.odds + run.teams);
+        return true;
+    }
+    return false;
+}
+
+// Reads the run headers and odds columns only
+HistoryStore::BestOdds HistoryStore::bestOddsWins() const
+{
+    BestOdds result;
+    std::uint64_t offset = 0;
+    RunView run;
+    while (nextRun(offset, run))
+    {
+        int favourite = 0;
+        std::int64_t total = 0;
+        for (int team = 0; team < run.teams; ++team)
+        {
+            total += run.odds[team];
+            if (run.odds[team] > run.odds[favourite])
+                favourite = team;
+        }
+        if (total <= 0)
+            continue;
+
+        ++result.runs;
+        result.wins += run.winner == favourite;
+        result.expectedWins += static_cast<double>(run.odds[favourite]) / total;
+    }
+    return result;
+}
+
+// Reads the run headers, odds and pick columns, the names are never touched
+std::vector<HistoryStore::PickDistribution> HistoryStore::pickDistributions() const
+{
+    std::vector<PickDistribution> groups;
+    // Groups whose odds, format and mode hash to the same key, more than one only on a collision
+    std::unordered_map<std::uint64_t, std::vector<std::size_t>> byKey;
+
+    auto matches = [](const PickDistribution &group, const RunView &run)
+    {
+        return group.teams() == run.teams && group.weightedOrder == run.weightedOrder && group.format == run.format &&
+               std::equal(group.odds.begin(), group.odds.end(), run.odds);
+    };
+
+    std::uint64_t offset = 0;
+    RunView run;
+    std::size_t last = 0;
+    while (nextRun(offset, run))
+    {
+        // Seasons keep one table for many runs in a row, so the last group is tried first
+        std::size_t index = last;
+        if (groups.empty() || !matches(groups[index], run))
+        {
+            std::uint64_t key = run.oddsHash ^ (std::uint64_t(run.format) << 1) ^ run.weightedOrder;
+            std::vector<std::size_t> &bucket = byKey[key];
+            auto same = std::find_if(bucket.begin(), bucket.end(), [&](std::size_t candidate)
+                                     { return matches(groups[candidate], run); });
+            if (same != bucket.end())
+                index = *same;
+            else
+            {
+                index = groups.size();
+                PickDistribution group;
+                group.odds.assign(run.odds, run.odds + run.teams);
+                group.weightedOrder = run.weightedOrder;
+                group.format = run.format;
+                group.counts.assign(static_cast<std::size_t>(run.teams) * run.teams, 0);
+                groups.push_back(std::move(group));
+                bucket.push_back(index);
+            }
+        }
+        last = index;
+
+        PickDistribution &group = groups[index];
+        ++group.runs;
+        for (int team = 0; team < run.teams; ++team)
+            ++group.counts[static_cast<std::size_t>(team) * run.teams + run.picks[team]];
+    }
+
+    std::stable_sort(groups.begin(), groups.end(), [](const PickDistribution &a, const PickDistribution &b)
+                     { return a.runs > b.runs; });
+    return groups;
+}
@@ -0,0 +1,122 @@
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include "mappedfile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Append-only log of every lottery drawn, read back through a memory mapping.
+// Each run is one record: a fixed header with the time, seed, draw number and
+// winner, then the per-team fields as columns (name ids, odds, picks) so a
+// query reads only the columns it needs. Team and format names are interned
+// in name records the first time they appear. Queries walk the mapping in
+// place, nothing is copied out per run, so millions of runs take a few
+// hundred megabytes of page cache and no heap.
+// A run cut short by a crash is dropped the next time the log is opened.
+// Not thread-safe, callers serialize appends and queries.
+class HistoryStore
+{
+public:
+    // Picks are stored as bytes
+    static constexpr int maxTeams = 256;
+    static constexpr std::uint32_t noName = 0xffffffffu;
+
+    struct Run
+    {
+        std::int64_t timestamp = 0; // Milliseconds since the Unix epoch
+        std::uint64_t seed = 0;
+        std::uint64_t draw = 0;
+        bool weightedOrder = false;
+        std::string format; // Empty for the app's own rules
+        std::vector<std::string> names;
+        std::vector<std::int32_t> odds;
+        std::vector<int> order; // Team indices in pick order, the winner first
+    };
+
+    // One stored run, pointing into the mapping. Valid until the next append or close.
+    struct RunView
+    {
+        std::int64_t timestamp;
+        std::uint64_t seed;
+        std::uint64_t draw;
+        bool weightedOrder;
+        std::uint32_t format;
+        std::uint64_t oddsHash; // Equal odds tables hash equal
+        int teams;
+        int winner;
+        const std::uint32_t *names;
+        const std::int32_t *odds;
+        const std::uint8_t *picks; // picks[team] is the team's pick, 0 for the winner
+    };
+
+    struct BestOdds
+    {
+        std::uint64_t runs = 0;
+        std::uint64_t wins = 0;
+        double expectedWins = 0.0; // Sum over the runs of the favourite's share of the odds
+    };
+
+    // Every run drawn from one odds table under one set of rules
+    struct PickDistribution
+    {
+        std::vector<std::int32_t> odds;
+        bool weightedOrder = false;
+        std::uint32_t format = noName;
+        std::uint64_t runs = 0;
+        std::vector<std::uint64_t> counts; // counts[team * teams() + pick]
+
+        int teams() const { return static_cast<int>(odds.size()); }
+    };
+
+    HistoryStore() = default;
+    ~HistoryStore();
+
+    HistoryStore(const HistoryStore &) = delete;
+    HistoryStore &operator=(const HistoryStore &) = delete;
+
+    // Opens the log, creating it if it is missing or empty. Reads the name records and drops a torn last record.
+    bool open(const std::string &path);
+    void close();
+
+    bool append(const Run &run);
+
+    bool isOpen() const { return file != nullptr; }
+    const std::string &errorString() const { return error; }
+
+    std::uint64_t runCount() const { return runs; }
+    std::uint64_t sizeInBytes() const { return end; }
+    const std::string &name(std::uint32_t id) const;
+
+    // Walks the runs oldest first: start with offset 0, false once there are no more
+    bool nextRun(std::uint64_t &offset, RunView &run) const;
+
+    // How often the team with the highest odds won, ties go to the team listed first
+    BestOdds bestOddsWins() const;
+
+    // Observed picks of every distinct odds table and rules, most runs first
+    std::vector<PickDistribution> pickDistributions() const;
+
+private:
+    bool scan();
+    bool refresh() const;
+    std::uint32_t intern(const std::string &name);
+
+    std::string path;
+    std::FILE *file = nullptr;
+    std::uint64_t end = 0;
+    std::uint64_t runs = 0;
+    std::string error;
+
+    std::vector<std::string> names;
+    std::unordered_map<std::string, std::uint32_t> nameIds;
+
+    // Remapped when a query finds the log grew since the last mapping
+    mutable MappedFile mapping;
+};
+
+#endif // HISTORYSTORE_H
@@ -0,0 +1,86 @@
+#include "lotteryengine.h"
+
+#include <limits>
+
+LotteryEngine::LotteryEngine(const std::vector<std::int64_t> &weights)
+{
+    setWeights(weights);
+}
+
+// Builds the alias table with Vose's method using exact integer masses
+bool LotteryEngine::setWeights(const std::vector<std::int64_t> &newWeights)
+{
+    weights.clear();
+    columns.clear();
+    total = 0;
+
+    const std::uint64_t n = newWeights.size();
+    if (n == 0 || n > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+        return false;
+
+    std::uint64_t sum = 0;
+    for (std::int64_t w : newWeights)
+    {
+        if (w <= 0)
+            continue;
+        if (sum > std::numeric_limits<std::uint64_t>::max() - static_cast<std::uint64_t>(w))
+            return false;
+        sum += static_cast<std::uint64_t>(w);
+    }
+
+    // Each weight is scaled by n so every column holds exactly `sum` units,
+    // which must not overflow
+    if (sum == 0 || sum > std::numeric_limits<std::uint64_t>::max() / n)
+        return false;
+
+    std::vector<std::uint64_t> scaled(n);
+    std::vector<int> small;
+    std::vector<int> large;
+    small.reserve(n);
+    large.reserve(n);
+
+    for (std::uint64_t i = 0; i < n; ++i)
+    {
+        scaled[i] = newWeights[i] > 0 ? static_cast<std::uint64_t>(newWeights[i]) * n : 0;
+        if (scaled[i] < sum)
+            small.push_back(static_cast<int>(i));
+        else
+            large.push_back(static_cast<int>(i));
+    }
+
+    columns.resize(n);
+
+    // Pair each under-full column with an over-full one that tops it up
+    while (!small.empty() && !large.empty())
+    {
+        int s = small.back();
+        small.pop_back();
+        int l = large.back();
+
+        columns[s].threshold = scaled[s];
+        columns[s].alias = l;
+
+        scaled[l] -= sum - scaled[s];
+        if (scaled[l] < sum)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // Whatever is left is exactly full since all arithmetic is exact
+    for (int l : large)
+    {
+        columns[l].threshold = sum;
+        columns[l].alias = l;
+    }
+    for (int s : small)
+    {
+        columns[s].threshold = sum;
+        columns[s].alias = s;
+    }
+
+    weights = newWeights;
+    total = sum;
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef LOTTERYENGINE_H
+#define LOTTERYENGINE_H
+
+#include "uniformrandom.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Weighted winner draw with no GUI dependencies.
+// The weights are turned into a Walker/Vose alias table once, after which
+// every draw is O(1): one uniform column pick and one integer comparison.
+// All arithmetic is integer so the odds are reproduced exactly.
+class LotteryEngine
+{
+public:
+    LotteryEngine() = default;
+    explicit LotteryEngine(const std::vector<std::int64_t> &weights);
+
+    // Rebuilds the alias table, non-positive weights can never be drawn.
+    // Returns false (and leaves the engine empty) if no weight is positive
+    // or the total does not fit the table.
+    bool setWeights(const std::vector<std::int64_t> &weights);
+
+    bool isValid() const { return total > 0; }
+    int teamCount() const { return static_cast<int>(weights.size()); }
+    std::int64_t weight(int index) const { return weights[index]; }
+    std::uint64_t totalWeight() const { return total; }
+
+    // Draws a single winner index, or -1 if the engine is empty
+    template <typename Rng>
+    int draw(Rng &rng) const
+    {
+        if (!isValid())
+            return -1;
+
+        std::size_t column = static_cast<std::size_t>(uniformBelow(rng, columns.size()));
+        const Column &c = columns[column];
+        return uniformBelow(rng, total) < c.threshold ? static_cast<int>(column) : c.alias;
+    }
+
+    // Fills out[0..count) with independent winners
+    template <typename Rng>
+    void drawBatch(int *out, std::size_t count, Rng &rng) const
+    {
+        if (!isValid())
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                out[i] = -1;
+            return;
+        }
+
+        const Column *table = columns.data();
+        const std::uint64_t n = columns.size();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const Column &c = table[uniformBelow(rng, n)];
+            out[i] = uniformBelow(rng, total) < c.threshold ? static_cast<int>(&c - table) : c.alias;
+        }
+    }
+
+private:
+    // Each column owns `threshold` out of `total` units of mass, the rest belongs to `alias`
+    struct Column
+    {
+        std::uint64_t threshold;
+        int alias;
+    };
+
+    std::vector<std::int64_t> weights;
+    std::vector<Column> columns;
+    std::uint64_t total = 0;
+};
+
+#endif // LOTTERYENGINE_H
@@ -0,0 +1,14 @@
+# Links a project against the lotteryengine static library
+LOTTERYENGINE_OUT = $$shadowed($$PWD)
+
+win32:CONFIG(release, debug|release): LOTTERYENGINE_LIBDIR = $$LOTTERYENGINE_OUT/release
+else:win32:CONFIG(debug, debug|release): LOTTERYENGINE_LIBDIR = $$LOTTERYENGINE_OUT/debug
+else: LOTTERYENGINE_LIBDIR = $$LOTTERYENGINE_OUT
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+LIBS += -L$$LOTTERYENGINE_LIBDIR -llotteryengine
+
+win32-msvc*: PRE_TARGETDEPS += $$LOTTERYENGINE_LIBDIR/lotteryengine.lib
+else: PRE_TARGETDEPS += $$LOTTERYENGINE_LIBDIR/liblotteryengine.a
@@ -0,0 +1,31 @@
+TEMPLATE = lib
+CONFIG += staticlib c++17
+CONFIG -= qt
+TARGET = lotteryengine
+
+QMAKE_CXXFLAGS_RELEASE += -O3
+CONFIG += optimize_full
+
+SOURCES += \
+    dynamicsampler.cpp \
+    entryfile.cpp \
+    exactpickodds.cpp \
+    historystore.cpp \
+    lotteryengine.cpp \
+    mappedfile.cpp \
+    pickoddssimulator.cpp \
+    weightedorder.cpp
+
+HEADERS += \
+    draftorder.h \
+    dynamicsampler.h \
+    entryfile.h \
+    exactpickodds.h \
+    historystore.h \
+    lotteryengine.h \
+    lotteryrules.h \
+    mappedfile.h \
+    philox.h \
+    pickoddssimulator.h \
+    uniformrandom.h \
+    weightedorder.h
@@ -0,0 +1,339 @@
+#ifndef LOTTERYRULES_H
+#define LOTTERYRULES_H
+
+#include "lotteryengine.h"
+#include "philox.h"
+#include "pickoddssimulator.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Draft lottery formats built from compile-time rule policies.
+// Teams are given in pre-lottery order, index 0 has the worst record and
+// would pick first without a lottery. The first `Picks` picks are drawn the
+// way the leagues do it: a ball combination is drawn from the whole table and
+// redrawn if it is unassigned, belongs to a team that already won a draw or
+// to a team a fall rule makes ineligible for this pick. A team that wins a
+// draw beyond its jump limit moves up only as far as the limit allows and
+// the pick goes to the best placed team left. Everyone left picks in
+// pre-lottery order after the drawn picks. The rules are template
+// parameters, so each format's draw loop is compiled with its checks inlined
+// and the ones it doesn't use compiled away.
+
+// Any team may win any lottery pick
+struct NoJumpLimit
+{
+    static constexpr bool eligible(int, int) { return true; }
+    static constexpr int landing(int slot) { return slot; }
+};
+
+// A team moves up at most Spots places. Winning a draw for a pick further up
+// moves it up exactly Spots places instead and the pick goes to the team
+// placed highest among those left, like the NHL since 2021.
+template <int Spots>
+struct MaxJump
+{
+    static_assert(Spots >= 0, "a jump limit can't be negative");
+    static constexpr bool eligible(int slot, int pick) { return slot - pick <= Spots; }
+
+    // The slot a team that won too far up is placed at among the teams picking in order
+    static constexpr int landing(int slot) { return slot - Spots; }
+};
+
+// Teams may fall any number of places, which with k drawn picks is at most k
+struct NoFallLimit
+{
+    void reset() {}
+    bool eligible(int) const { return true; }
+    void drawn(int, std::uint64_t) {}
+};
+
+// No team falls more than Spots places below its pre-lottery slot.
+// Every pick won by a team behind an undrawn team pushes that team down one
+// place. Once a team has been pushed Spots places, teams behind it can't win
+// any further pick, and the team itself and the teams ahead of it still can.
+template <int Spots>
+class MaxFall
+{
+public:
+    static_assert(Spots >= 1, "a fall limit of 0 would leave nothing to draw");
+
+    void reset()
+    {
+        fallen.fill(0);
+        firstBlocked = maxTeams;
+    }
+
+    bool eligible(int slot) const { return slot <= firstBlocked; }
+
+    // `taken` has a bit set for every team drawn so far, including `slot`
+    void drawn(int slot, std::uint64_t taken)
+    {
+        firstBlocked = maxTeams;
+        for (int s = 0; s < slot; ++s)
+        {
+            if (!(taken >> s & 1) && ++fallen[s] >= Spots && s < firstBlocked)
+                firstBlocked = s;
+        }
+        for (int s = slot + 1; s < maxTeams && firstBlocked == maxTeams; ++s)
+        {
+            if (!(taken >> s & 1) && fallen[s] >= Spots)
+                firstBlocked = s;
+        }
+    }
+
+private:
+    static const int maxTeams = 64;
+
+    std::array<std::uint8_t, maxTeams> fallen;
+    int firstBlocked = maxTeams;
+};
+
+template <int Picks, typename JumpRule = NoJumpLimit, typename FallRule = NoFallLimit>
+class DraftLottery
+{
+public:
+    static_assert(Picks >= 1, "a lottery draws at least one pick");
+
+    static constexpr int picks = Picks;
+
+    // The draw keeps a bitmask of drawn teams
+    static const int maxTeams = 64;
+
+    DraftLottery() = default;
+
+    // `combinations[i]` is team i's share of `totalCombinations`, which
+    // defaults to their sum. Combinations left over are drawn and redrawn,
+    // like the NBA's unassigned 1001st combination.
+    explicit DraftLottery(const std::vector<std::int64_t> &combinations, std::int64_t totalCombinations = 0)
+    {
+        setCombinations(combinations, totalCombinations);
+    }
+
+    // Returns false and leaves the lottery empty if no team has combinations,
+    // there are more than maxTeams teams or the total is smaller than their sum
+    bool setCombinations(const std::vector<std::int64_t> &combinations, std::int64_t totalCombinations = 0)
+    {
+        teams = 0;
+        if (combinations.empty() || combinations.size() > static_cast<std::size_t>(maxTeams))
+            return false;
+
+        std::int64_t assigned = 0;
+        for (std::int64_t c : combinations)
+            assigned += c > 0 ? c : 0;
+        if (totalCombinations == 0)
+            totalCombinations = assigned;
+        if (assigned <= 0 || totalCombinations < assigned)
+            return false;
+
+        // Unassigned combinations are one more entry that always gets redrawn
+        std::vector<std::int64_t> table = combinations;
+        if (totalCombinations > assigned)
+            table.push_back(totalCombinations - assigned);
+        if (!engine.setWeights(table))
+            return false;
+
+        teams = static_cast<int>(combinations.size());
+        return true;
+    }
+
+    bool isValid() const { return teams > 0; }
+    int teamCount() const { return teams; }
+
+    // order[pick] is the pre-lottery slot of the team making that pick, order must hold teamCount() entries
+    template <typename Rng>
+    void draw(Rng &rng, int *order) const
+    {
+        FallRule fall;
+        fall.reset();
+        std::uint64_t taken = 0;
+
+        // Teams that won beyond the jump limit, sorted by where they land
+        std::array<int, Picks> jumped;
+        int jumps = 0;
+
+        const int lotteryPicks = Picks < teams ? Picks : teams;
+        for (int pick = 0; pick < lotteryPicks; ++pick)
+        {
+            int team = -1;
+            for (int attempt = 0; attempt < maxRedraws; ++attempt)
+            {
+                int ball = engine.draw(rng);
+                if (ball < teams && !(taken >> ball & 1) && fall.eligible(ball))
+                {
+                    team = ball;
+                    break;
+                }
+            }
+
+            if (team >= 0 && !JumpRule::eligible(team, pick))
+            {
+                taken |= std::uint64_t(1) << team;
+                int at = jumps++;
+                for (; at > 0 && JumpRule::landing(jumped[at - 1]) > JumpRule::landing(team); --at)
+                    jumped[at] = jumped[at - 1];
+                jumped[at] = team;
+                team = -1;
+            }
+
+            // The jump limit gives the pick away in order, so does a table the rules leave without combinations
+            if (team < 0)
+                team = firstUndrawn(taken, pick, fall);
+
+            taken |= std::uint64_t(1) << team;
+            fall.drawn(team, taken);
+            order[pick] = team;
+        }
+
+        // A team that jumped goes in front of the team whose slot it landed on
+        int next = lotteryPicks;
+        int jump = 0;
+        for (int slot = 0; slot < teams; ++slot)
+        {
+            for (; jump < jumps && JumpRule::landing(jumped[jump]) <= slot; ++jump)
+                order[next++] = jumped[jump];
+            if (!(taken >> slot & 1))
+                order[next++] = slot;
+        }
+    }
+
+    template <typename Rng>
+    std::vector<int> draw(Rng &rng) const
+    {
+        std::vector<int> order(static_cast<std::size_t>(teams));
+        if (isValid())
+            draw(rng, order.data());
+        return order;
+    }
+
+    // Where every team lands over `trials` lotteries, spread over `threads` workers (0 uses every core).
+    // Worker t draws from stream t of `seed`, so results don't depend on scheduling.
+    PickOddsResult simulate(std::uint64_t trials, unsigned threads = 0, std::uint64_t seed = 0) const
+    {
+        if (!isValid())
+            return PickOddsResult();
+
+        const int n = teams;
+        return runPickOddsWorkers(n, trials, threads, [this, n, seed](std::uint64_t share, unsigned stream, std::uint64_t *counts)
+                                  {
+            Philox4x32 rng(seed, stream);
+            std::array<int, maxTeams> order;
+            for (std::uint64_t trial = 0; trial < share; ++trial)
+            {
+                draw(rng, order.data());
+                for (int pick = 0; pick < n; ++pick)
+                    ++counts[static_cast<std::size_t>(order[pick]) * n + pick];
+            } });
+    }
+
+private:
+    // Past this many redraws in a row the pick goes to the best placed eligible team
+    static const int maxRedraws = 1024;
+
+    template <typename Fall>
+    int firstUndrawn(std::uint64_t taken, int pick, const Fall &fall) const
+    {
+        for (int slot = 0; slot < teams; ++slot)
+        {
+            if (!(taken >> slot & 1) && JumpRule::eligible(slot, pick) && fall.eligible(slot))
+                return slot;
+        }
+        for (int slot = 0; slot < teams; ++slot)
+        {
+            if (!(taken >> slot & 1))
+                return slot;
+        }
+        return -1;
+    }
+
+    LotteryEngine engine;
+    int teams = 0;
+};
+
+// A league's published odds, in pre-lottery order
+template <std::size_t Teams>
+struct OddsTable
+{
+    std::array<std::int64_t, Teams> combinations;
+    std::int64_t totalCombinations;
+
+    constexpr std::int64_t assigned() const
+    {
+        std::int64_t sum = 0;
+        for (std::int64_t c : combinations)
+            sum += c;
+        return sum;
+    }
+
+    std::vector<std::int64_t> toVector() const { return std::vector<std::int64_t>(combinations.begin(), combinations.end()); }
+};
+
+namespace LotteryFormats
+{
+    // NBA since 2019: the 14 non-playoff teams, 1000 of 1001 combinations, four picks drawn
+    struct Nba2019
+    {
+        using Lottery = DraftLottery<4>;
+        static constexpr const char *name = "nba";
+        static constexpr OddsTable<14> odds = {{140, 140, 140, 125, 105, 90, 75, 60, 45, 30, 20, 15, 10, 5}, 1001};
+    };
+
+    // NBA 1994 to 2018: three picks drawn, the worst team falls to fourth at most
+    struct Nba1994
+    {
+        using Lottery = DraftLottery<3>;
+        static constexpr const char *name = "nba1994";
+        static constexpr OddsTable<14> odds = {{250, 199, 156, 119, 88, 63, 43, 28, 17, 11, 8, 7, 6, 5}, 1001};
+    };
+
+    // NHL since 2021: two picks drawn from 16 teams, no team moves up more than 10 places
+    struct Nhl2021
+    {
+        using Lottery = DraftLottery<2, MaxJump<10>>;
+        static constexpr const char *name = "nhl";
+        static constexpr OddsTable<16> odds = {{185, 135, 115, 95, 85, 75, 65, 60, 50, 35, 30, 25, 20, 15, 5, 5}, 1000};
+    };
+
+    static_assert(Nba2019::odds.assigned() == 1000, "NBA 2019 odds must assign 1000 combinations");
+    static_assert(Nba1994::odds.assigned() == 1000, "NBA 1994 odds must assign 1000 combinations");
+    static_assert(Nhl2021::odds.assigned() == 1000, "NHL 2021 odds must add up to 100%");
+
+    // The format's lottery with its published odds
+    template <typename Format>
+    typename Format::Lottery lottery()
+    {
+        return typename Format::Lottery(Format::odds.toVector(), Format::odds.totalCombinations);
+    }
+
+    // Calls f(Format{}) with the format called `name`, the only place a
+    // format is picked at run time. Returns false for an unknown name.
+    template <typename F>
+    bool withFormat(const char *name, F &&f)
+    {
+        auto is = [name](const char *candidate)
+        {
+            const char *a = name;
+            const char *b = candidate;
+            while (*a && *a == *b)
+            {
+                ++a;
+                ++b;
+            }
+            return *a == *b;
+        };
+
+        if (is(Nba2019::name))
+            f(Nba2019());
+        else if (is(Nba1994::name))
+            f(Nba1994());
+        else if (is(Nhl2021::name))
+            f(Nhl2021());
+        else
+            return false;
+        return true;
+    }
+}
+
+#endif // LOTTERYRULES_H
@@ -0,0 +1,115 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Stands in for the mapping of an empty file, which cannot be mapped
+    const char emptyFile[1] = {0};
+}
+
+bool MappedFile::map(const std::string &path, std::string &error)
+{
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        error = "Could not open " + path;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize))
+    {
+        CloseHandle(handle);
+        error = "Could not read the size of " + path;
+        return false;
+    }
+
+    size = static_cast<std::size_t>(fileSize.QuadPart);
+    if (size == 0)
+    {
+        CloseHandle(handle);
+        data = emptyFile;
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void *address = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!address)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(handle);
+        error = "Could not map " + path;
+        return false;
+    }
+
+    file = handle;
+    view = mapping;
+    data = static_cast<const char *>(address);
+    return true;
+#else
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+    {
+        error = "Could not open " + path;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(descriptor, &info) != 0)
+    {
+        ::close(descriptor);
+        error = "Could not read the size of " + path;
+        return false;
+    }
+
+    size = static_cast<std::size_t>(info.st_size);
+    if (size == 0)
+    {
+        ::close(descriptor);
+        data = emptyFile;
+        return true;
+    }
+
+    void *address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+    if (address == MAP_FAILED)
+    {
+        error = "Could not map " + path;
+        return false;
+    }
+
+    madvise(address, size, MADV_SEQUENTIAL);
+    data = static_cast<const char *>(address);
+    return true;
+#endif
+}
+
+void MappedFile::unmap()
+{
+    if (data && data != emptyFile)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle(view);
+        CloseHandle(file);
+        view = nullptr;
+        file = nullptr;
+#else
+        munmap(const_cast<char *>(data), size);
+#endif
+    }
+    data = nullptr;
+    size = 0;
+}
@@ -0,0 +1,24 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file.
+// An empty file cannot be mapped, it gets a valid zero-length view instead.
+struct MappedFile
+{
+    const char *data = nullptr;
+    std::size_t size = 0;
+#ifdef _WIN32
+    void *file = nullptr;
+    void *view = nullptr;
+#endif
+
+    // Every reader walks its file front to back, so the kernel is told to read ahead.
+    // The file may grow while it is mapped, the view keeps the size it had.
+    bool map(const std::string &path, std::string &error);
+    void unmap();
+};
+
+#endif // MAPPEDFILE_H
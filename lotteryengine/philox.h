@@ -0,0 +1,148 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random
+// numbers: as easy as 1, 2, 3").
+// Output block n of stream s is a pure function of (seed, s, n), so any
+// position of any stream can be reached in O(1) and every thread or lottery
+// can own an independent stream of the same seed. A recorded seed, stream
+// and position reproduce a draw exactly on every platform.
+// Works as a UniformRandomBitGenerator with the helpers in uniformrandom.h.
+class Philox4x32
+{
+public:
+    using result_type = std::uint64_t;
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+    explicit Philox4x32(std::uint64_t seed = 0, std::uint64_t stream = 0)
+        : key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)},
+          stream{static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32)}
+    {
+    }
+
+    result_type operator()()
+    {
+        if ((next & 1) == 0)
+            block(next >> 1, buffered);
+        return buffered[next++ & 1];
+    }
+
+    // Jumps to the `position`-th output of the stream, in O(1)
+    void seek(std::uint64_t position)
+    {
+        next = position;
+        if (next & 1)
+            block(next >> 1, buffered);
+    }
+
+    void discard(std::uint64_t count) { seek(next + count); }
+
+    // Number of outputs produced so far
+    std::uint64_t position() const { return next; }
+
+    // Same values as calling operator() `count` times. Whole blocks are
+    // generated in independent lanes so the rounds vectorize.
+    void generate(result_type *out, std::size_t count)
+    {
+        std::size_t i = 0;
+        if ((next & 1) && count > 0)
+            out[i++] = (*this)();
+
+        std::uint32_t lanes0[lanes], lanes1[lanes], lanes2[lanes], lanes3[lanes];
+        while (count - i >= 2 * lanes)
+        {
+            std::uint64_t first = next >> 1;
+            for (std::size_t lane = 0; lane < lanes; ++lane)
+            {
+                lanes0[lane] = static_cast<std::uint32_t>(first + lane);
+                lanes1[lane] = static_cast<std::uint32_t>((first + lane) >> 32);
+                lanes2[lane] = stream[0];
+                lanes3[lane] = stream[1];
+            }
+
+            encrypt(lanes0, lanes1, lanes2, lanes3);
+
+            for (std::size_t lane = 0; lane < lanes; ++lane)
+            {
+                out[i + 2 * lane] = lanes0[lane] | (static_cast<std::uint64_t>(lanes1[lane]) << 32);
+                out[i + 2 * lane + 1] = lanes2[lane] | (static_cast<std::uint64_t>(lanes3[lane]) << 32);
+            }
+            i += 2 * lanes;
+            next += 2 * lanes;
+        }
+
+        while (i < count)
+            out[i++] = (*this)();
+    }
+
+private:
+    static constexpr std::uint32_t multiplier0 = 0xD2511F53;
+    static constexpr std::uint32_t multiplier1 = 0xCD9E8D57;
+    static constexpr std::uint32_t weyl0 = 0x9E3779B9;
+    static constexpr std::uint32_t weyl1 = 0xBB67AE85;
+    static constexpr int rounds = 10;
+
+    // Blocks encrypted side by side by generate()
+    static constexpr std::size_t lanes = 64;
+
+    // Runs the rounds over every lane, one round at a time so each step is a vector operation
+    void encrypt(std::uint32_t *__restrict c0, std::uint32_t *__restrict c1, std::uint32_t *__restrict c2, std::uint32_t *__restrict c3) const
+    {
+        std::uint32_t k0 = key[0], k1 = key[1];
+        for (int round = 0; round < rounds; ++round)
+        {
+            for (std::size_t lane = 0; lane < lanes; ++lane)
+            {
+                std::uint64_t p0 = static_cast<std::uint64_t>(multiplier0) * c0[lane];
+                std::uint64_t p1 = static_cast<std::uint64_t>(multiplier1) * c2[lane];
+                std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1[lane] ^ k0;
+                std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3[lane] ^ k1;
+                c1[lane] = static_cast<std::uint32_t>(p1);
+                c3[lane] = static_cast<std::uint32_t>(p0);
+                c0[lane] = n0;
+                c2[lane] = n2;
+            }
+            k0 += weyl0;
+            k1 += weyl1;
+        }
+    }
+
+    // Encrypts counter (index, stream) into two 64-bit outputs
+    void block(std::uint64_t index, std::uint64_t *out) const
+    {
+        std::uint32_t c0 = static_cast<std::uint32_t>(index);
+        std::uint32_t c1 = static_cast<std::uint32_t>(index >> 32);
+        std::uint32_t c2 = stream[0];
+        std::uint32_t c3 = stream[1];
+        std::uint32_t k0 = key[0], k1 = key[1];
+
+        for (int round = 0; round < rounds; ++round)
+        {
+            std::uint64_t p0 = static_cast<std::uint64_t>(multiplier0) * c0;
+            std::uint64_t p1 = static_cast<std::uint64_t>(multiplier1) * c2;
+            std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c1 = static_cast<std::uint32_t>(p1);
+            c3 = static_cast<std::uint32_t>(p0);
+            c0 = n0;
+            c2 = n2;
+            k0 += weyl0;
+            k1 += weyl1;
+        }
+
+        out[0] = c0 | (static_cast<std::uint64_t>(c1) << 32);
+        out[1] = c2 | (static_cast<std::uint64_t>(c3) << 32);
+    }
+
+    std::uint32_t key[2];
+    std::uint32_t stream[2];
+    std::uint64_t next = 0;
+    std::uint64_t buffered[2] = {0, 0};
+};
+
+#endif // PHILOX_H
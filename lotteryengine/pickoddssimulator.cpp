@@ -0,0 +1,84 @@
+#include "pickoddssimulator.h"
+#include "philox.h"
+#include "weightedorder.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+PickOddsSimulator::PickOddsSimulator(const std::vector<std::int64_t> &weights, OrderMode mode)
+    : engine(weights), weights(weights), mode(mode)
+{
+}
+
+PickOddsResult PickOddsSimulator::run(std::uint64_t trials, unsigned threads, std::uint64_t seed) const
+{
+    if (!isValid())
+        return PickOddsResult();
+
+    return runPickOddsWorkers(engine.teamCount(), trials, threads, [this, seed](std::uint64_t share, unsigned stream, std::uint64_t *counts)
+                              { runStream(share, seed, stream, counts); });
+}
+
+std::uint64_t PickOddsSimulator::runStream(std::uint64_t trials, std::uint64_t seed, unsigned stream, std::uint64_t *counts,
+                                           const std::atomic<bool> *cancelled) const
+{
+    // Checked every few thousand lotteries, often enough to stop within a millisecond
+    const std::uint64_t cancelCheck = 4096;
+    auto stopped = [cancelled](std::uint64_t trial)
+    { return cancelled && trial % cancelCheck == 0 && cancelled->load(std::memory_order_relaxed); };
+
+    const int n = engine.teamCount();
+
+    // Each worker owns one stream of the seed, so results do not depend on scheduling
+    Philox4x32 rng(seed, stream);
+
+    // order[slot] is the team in that slot, position[team] is the inverse
+    std::vector<int> order(n);
+    std::vector<int> position(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::iota(position.begin(), position.end(), 0);
+
+    if (mode == OrderMode::WeightedOrder)
+    {
+        WeightedOrderSampler sampler(weights);
+        for (std::uint64_t trial = 0; trial < trials; ++trial)
+        {
+            if (stopped(trial))
+                return trial;
+            sampler.draw(0, rng, order);
+            for (std::size_t slot = 0; slot < order.size(); ++slot)
+                ++counts[static_cast<std::size_t>(order[slot]) * n + slot];
+        }
+        return trials;
+    }
+
+    for (std::uint64_t trial = 0; trial < trials; ++trial)
+    {
+        if (stopped(trial))
+            return trial;
+
+        // The winner takes the first slot
+        int winner = engine.draw(rng);
+        int previous = order[0];
+        order[0] = winner;
+        order[position[winner]] = previous;
+        position[previous] = position[winner];
+        position[winner] = 0;
+
+        // Everyone else is eliminated in a uniformly shuffled order,
+        // the first team eliminated gets the last pick
+        for (int i = n - 1; i > 1; --i)
+        {
+            int j = 1 + static_cast<int>(uniformBelow(rng, static_cast<std::uint64_t>(i)));
+            std::swap(order[i], order[j]);
+        }
+
+        for (int slot = 0; slot < n; ++slot)
+        {
+            position[order[slot]] = slot;
+            ++counts[static_cast<std::size_t>(order[slot]) * n + slot];
+        }
+    }
+    return trials;
+}
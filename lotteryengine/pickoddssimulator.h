@@ -0,0 +1,118 @@
+#ifndef PICKODDSSIMULATOR_H
+#define PICKODDSSIMULATOR_H
+
+#include "lotteryengine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Histogram of where every team landed over many simulated lotteries
+struct PickOddsResult
+{
+    int teamCount = 0;
+    std::uint64_t trials = 0;
+    unsigned threads = 0;
+    double seconds = 0.0;
+
+    // counts[team * teamCount + slot], slot 0 is the first overall pick
+    std::vector<std::uint64_t> counts;
+
+    double probability(int team, int slot) const
+    {
+        return trials ? static_cast<double>(counts[static_cast<std::size_t>(team) * teamCount + slot]) / trials : 0.0;
+    }
+
+    double drawsPerSecondPerCore() const
+    {
+        return seconds > 0.0 && threads ? trials / seconds / threads : 0.0;
+    }
+};
+
+// Splits `trials` over `threads` workers (0 uses every hardware thread) and
+// merges their histograms. Each worker calls body(trials, stream, counts)
+// with a private histogram, so the hot loop never shares a cache line and
+// the caller's draw loop is inlined into it.
+template <typename Body>
+PickOddsResult runPickOddsWorkers(int teamCount, std::uint64_t trials, unsigned threads, Body body)
+{
+    PickOddsResult result;
+    const std::size_t cells = static_cast<std::size_t>(teamCount) * teamCount;
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    if (trials < threads)
+        threads = static_cast<unsigned>(std::max<std::uint64_t>(1, trials));
+
+    std::vector<std::vector<std::uint64_t>> histograms(threads, std::vector<std::uint64_t>(cells, 0));
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned t = 0; t < threads; ++t)
+    {
+        // Spread the remainder over the first few workers
+        std::uint64_t share = trials / threads + (t < trials % threads ? 1 : 0);
+        workers.emplace_back([&body, share, t, &histograms]()
+                             { body(share, t, histograms[t].data()); });
+    }
+    for (std::thread &worker : workers)
+        worker.join();
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.teamCount = teamCount;
+    result.trials = trials;
+    result.threads = threads;
+    result.counts.assign(cells, 0);
+
+    for (const std::vector<std::uint64_t> &histogram : histograms)
+    {
+        for (std::size_t i = 0; i < cells; ++i)
+            result.counts[i] += histogram[i];
+    }
+
+    return result;
+}
+
+// Runs the full lottery many times across all cores, either a weighted
+// winner draw followed by the random elimination order for everyone else, or
+// a fully weighted draft order.
+// Each worker has its own RNG stream and histogram, merged once at the end.
+class PickOddsSimulator
+{
+public:
+    // Every worker keeps a teams x teams histogram, 512 KiB each at this size
+    static constexpr int maxTeams = 256;
+
+    enum class OrderMode
+    {
+        WinnerThenShuffle,
+        WeightedOrder
+    };
+
+    explicit PickOddsSimulator(const std::vector<std::int64_t> &weights, OrderMode mode = OrderMode::WinnerThenShuffle);
+
+    // False past maxTeams teams
+    bool isValid() const { return engine.isValid() && engine.teamCount() <= maxTeams; }
+    int teamCount() const { return engine.teamCount(); }
+
+    // threads == 0 uses every hardware thread
+    PickOddsResult run(std::uint64_t trials, unsigned threads = 0, std::uint64_t seed = 0) const;
+
+    // Adds `trials` lotteries drawn from stream `stream` of `seed` to counts[team * teamCount() + slot],
+    // for callers running their own workers. Stops early once *cancelled is set, returns the trials run.
+    std::uint64_t runStream(std::uint64_t trials, std::uint64_t seed, unsigned stream, std::uint64_t *counts,
+                            const std::atomic<bool> *cancelled = nullptr) const;
+
+private:
+
+    LotteryEngine engine;
+    std::vector<std::int64_t> weights;
+    OrderMode mode;
+};
+
+#endif // PICKODDSSIMULATOR_H
@@ -0,0 +1,66 @@
+#ifndef UNIFORMRANDOM_H
+#define UNIFORMRANDOM_H
+
+#include <cstdint>
+#include <limits>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Helpers for turning any UniformRandomBitGenerator (std::mt19937_64,
+// QRandomGenerator, ...) into unbiased integers without modulo bias
+
+// Full 64 x 64 -> 128 bit multiply, returns the high half and stores the low half
+inline std::uint64_t mulHigh64(std::uint64_t a, std::uint64_t b, std::uint64_t &low)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    std::uint64_t high;
+    low = _umul128(a, b, &high);
+    return high;
+#else
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    low = static_cast<std::uint64_t>(product);
+    return static_cast<std::uint64_t>(product >> 64);
+#endif
+}
+
+// Returns 64 random bits, combining two draws if the generator only produces 32
+template <typename Rng>
+inline std::uint64_t next64(Rng &rng)
+{
+    static_assert(Rng::min() == 0, "generator must produce the full bit range");
+
+    if constexpr (Rng::max() >= std::numeric_limits<std::uint64_t>::max())
+    {
+        return static_cast<std::uint64_t>(rng());
+    }
+    else
+    {
+        static_assert(Rng::max() == std::numeric_limits<std::uint32_t>::max(),
+                      "generator must produce 32 or 64 random bits");
+        std::uint64_t high = static_cast<std::uint32_t>(rng());
+        return (high << 32) | static_cast<std::uint32_t>(rng());
+    }
+}
+
+// Uniform integer in [0, bound) using Lemire's multiply-and-reject method,
+// which avoids a division on almost every call
+template <typename Rng>
+inline std::uint64_t uniformBelow(Rng &rng, std::uint64_t bound)
+{
+    std::uint64_t low;
+    std::uint64_t high = mulHigh64(next64(rng), bound, low);
+
+    if (low < bound)
+    {
+        std::uint64_t threshold = (0 - bound) % bound;
+        while (low < threshold)
+        {
+            high = mulHigh64(next64(rng), bound, low);
+        }
+    }
+    return high;
+}
+
+#endif // UNIFORMRANDOM_H
@@ -0,0 +1,38 @@
+#include "weightedorder.h"
+
+#include <algorithm>
+
+WeightedOrderSampler::WeightedOrderSampler(const std::vector<std::int64_t> &weights)
+{
+    setWeights(weights);
+}
+
+void WeightedOrderSampler::setWeights(const std::vector<std::int64_t> &weights)
+{
+    eligible.clear();
+    eligible.reserve(weights.size());
+
+    for (std::size_t i = 0; i < weights.size(); ++i)
+    {
+        if (weights[i] > 0)
+            eligible.push_back({1.0 / static_cast<double>(weights[i]), static_cast<int>(i)});
+    }
+}
+
+// Moves the smallest keys to the front, then sorts only those
+void WeightedOrderSampler::select(std::size_t picks, std::vector<int> &order)
+{
+    if (picks == 0 || picks > keys.size())
+        picks = keys.size();
+
+    auto byKey = [](const Key &a, const Key &b)
+    { return a.key < b.key; };
+
+    if (picks < keys.size())
+        std::nth_element(keys.begin(), keys.begin() + picks, keys.end(), byKey);
+    std::sort(keys.begin(), keys.begin() + picks, byKey);
+
+    order.resize(picks);
+    for (std::size_t i = 0; i < picks; ++i)
+        order[i] = keys[i].index;
+}
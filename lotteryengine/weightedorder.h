@@ -0,0 +1,105 @@
+#ifndef WEIGHTEDORDER_H
+#define WEIGHTEDORDER_H
+
+#include "uniformrandom.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Draws a whole draft order (or the top k picks) weighted by odds, the same
+// as drawing a winner, removing it and re-drawing from the rest.
+// Uses Efraimidis-Spirakis exponential keys: every entry gets the key
+// E / weight with E ~ Exp(1), and the k smallest keys in ascending order are
+// the picks. A partial selection keeps this O(n + k log k), so a raffle with a
+// million tickets costs one pass instead of k renormalizations.
+class WeightedOrderSampler
+{
+public:
+    WeightedOrderSampler() = default;
+    explicit WeightedOrderSampler(const std::vector<std::int64_t> &weights);
+
+    void setWeights(const std::vector<std::int64_t> &weights);
+
+    // Entries with a positive weight, only these can be drawn
+    std::size_t eligibleCount() const { return eligible.size(); }
+
+    // Fills order with the first `picks` indices drawn (all eligible entries
+    // if picks is 0 or larger than the pool), order[0] is the first pick
+    template <typename Rng>
+    void draw(std::size_t picks, Rng &rng, std::vector<int> &order)
+    {
+        keys.resize(eligible.size());
+        for (std::size_t i = 0; i < eligible.size(); ++i)
+        {
+            // Uniform in (0, 1] so the logarithm is always finite
+            double u = static_cast<double>((next64(rng) >> 11) + 1) * 0x1.0p-53;
+            keys[i].key = -std::log(u) * eligible[i].inverseWeight;
+            keys[i].index = eligible[i].index;
+        }
+        select(picks, order);
+    }
+
+    // The same draw straight from a weight array that is not copied, such as
+    // a mapped entry file: only the `picks` smallest keys are kept in a heap,
+    // so it takes O(n log k) time and O(k) memory. Consumes the generator
+    // exactly like draw(), so both give the same picks. Returns the number of
+    // entries with a positive weight.
+    template <typename Rng>
+    static std::size_t drawTop(const std::int64_t *weights, std::size_t count, std::size_t picks, Rng &rng, std::vector<int> &order)
+    {
+        auto byKey = [](const Key &a, const Key &b)
+        { return a.key < b.key; };
+
+        std::vector<Key> heap;
+        std::size_t eligibleEntries = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (weights[i] <= 0)
+                continue;
+            ++eligibleEntries;
+
+            double u = static_cast<double>((next64(rng) >> 11) + 1) * 0x1.0p-53;
+            Key key = {-std::log(u) * (1.0 / static_cast<double>(weights[i])), static_cast<int>(i)};
+            if (picks == 0 || heap.size() < picks)
+            {
+                heap.push_back(key);
+                std::push_heap(heap.begin(), heap.end(), byKey);
+            }
+            else if (key.key < heap.front().key)
+            {
+                std::pop_heap(heap.begin(), heap.end(), byKey);
+                heap.back() = key;
+                std::push_heap(heap.begin(), heap.end(), byKey);
+            }
+        }
+
+        std::sort_heap(heap.begin(), heap.end(), byKey);
+        order.resize(heap.size());
+        for (std::size_t i = 0; i < heap.size(); ++i)
+            order[i] = heap[i].index;
+        return eligibleEntries;
+    }
+
+private:
+    struct Entry
+    {
+        double inverseWeight;
+        int index;
+    };
+
+    struct Key
+    {
+        double key;
+        int index;
+    };
+
+    void select(std::size_t picks, std::vector<int> &order);
+
+    std::vector<Entry> eligible;
+    std::vector<Key> keys;
+};
+
+#endif // WEIGHTEDORDER_H
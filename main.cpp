@@ -1,23 +1,323 @@
+#include "batchlottery.h"
+#include "draftorder.h"
 #include "mainwindow.h"
+#include "philox.h"
+#include "revealexporter.h"
+#include "soakrunner.h"
+#include "startupprofiler.h"
+#include "teamtablemodel.h"
+#include "tracer.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
 #include <QFontDatabase>
+#include <QFile>
 #include <QFont>
+#include <QImage>
+#include <QRandomGenerator>
+#include <QThread>
 
-int main(int argc, char *argv[])
+#include <cstdio>
+#include <memory>
+
+// The embedded font, decompressed out of the resources
+static QByteArray readFontResource()
 {
-    QApplication a(argc, argv);
-    int fontId = QFontDatabase::addApplicationFont(":/fonts/InterTight-VariableFont_wght.ttf");
+    QFile file(":/fonts/InterTight-Subset.ttf");
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
 
+// Makes the embedded font the application default
+static void setApplicationFont(const QByteArray &fontData)
+{
+    int fontId = QFontDatabase::addApplicationFontFromData(fontData);
     if (fontId != -1)
     {
         QString fontFamily = QFontDatabase::applicationFontFamilies(fontId).at(0);
 
         QFont defaultFont(fontFamily);
         defaultFont.setPointSize(12);
-        QApplication::setFont(defaultFont);
+        QGuiApplication::setFont(defaultFont);
+    }
+}
+
+// Stops recording and writes the trace, the traced threads must be idle by now
+static bool writeTrace(const QString &path)
+{
+    Tracer::stop();
+
+    std::string error;
+    if (!Tracer::writeChromeJson(QFile::encodeName(path).toStdString(), error))
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Runs every league given on the command line without creating a window
+static int runBatch(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("draftlottery");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs draft lotteries for many leagues and prints one JSON line per league.");
+    parser.addHelpOption();
+    parser.addOption({"batch", "Run without a window."});
+    parser.addOption({"weighted-order", "Draw every pick by odds instead of only the first overall pick."});
+    parser.addOption({"format", "Draw with a league's rules and published odds, teams listed worst first: nba, nba1994 or nhl.", "name"});
+    parser.addOption({"threads", "Leagues drawn at the same time, 0 uses every core.", "count", "0"});
+    parser.addOption({"seed", "Seed for reproducible draws, random if not given.", "number"});
+    parser.addOption({"raffle", "Draw winners from a large name,weight entry file instead of leagues.", "file"});
+    parser.addOption({"picks", "Winners drawn from the raffle file.", "count", "1"});
+    parser.addOption({"write-index", "Save a binary index next to the raffle file so later runs skip parsing."});
+    parser.addOption({"history", "Record every league drawn in this lottery history log.", "file"});
+    parser.addOption({"history-report", "Print how the lotteries recorded in a history log compare to their odds.", "file"});
+    parser.addPositionalArgument("files", "League files (JSON or CSV), - or nothing reads stdin.", "[files...]");
+    parser.process(app);
+
+    quint64 seed = parser.isSet("seed") ? parser.value("seed").toULongLong() : QRandomGenerator::global()->generate64();
+
+    if (parser.isSet("raffle"))
+    {
+        QString error;
+        if (!BatchLottery::drawRaffle(parser.value("raffle"), parser.value("picks").toInt(), seed, parser.isSet("write-index"), stdout, error))
+        {
+            std::fprintf(stderr, "%s\n", qPrintable(error));
+            return 2;
+        }
+        return 0;
+    }
+
+    if (parser.isSet("history-report"))
+    {
+        QString error;
+        if (!BatchLottery::reportHistory(parser.value("history-report"), stdout, error))
+        {
+            std::fprintf(stderr, "%s\n", qPrintable(error));
+            return 2;
+        }
+        return 0;
+    }
+
+    if (parser.isSet("format") && !BatchLottery::isFormat(parser.value("format")))
+    {
+        std::fprintf(stderr, "unknown lottery format %s\n", qPrintable(parser.value("format")));
+        return 2;
+    }
+
+    BatchLottery batch(seed, parser.isSet("weighted-order"), parser.value("format"));
+
+    QString historyError;
+    if (parser.isSet("history") && !batch.setHistory(parser.value("history"), historyError))
+    {
+        std::fprintf(stderr, "%s\n", qPrintable(historyError));
+        return 2;
+    }
+
+    QStringList files = parser.positionalArguments();
+    if (files.isEmpty())
+        files.append("-");
+
+    for (const QString &file : files)
+    {
+        QString error;
+        if (!batch.load(file, error))
+        {
+            std::fprintf(stderr, "%s\n", qPrintable(error));
+            return 2;
+        }
+    }
+
+    int failed = batch.run(parser.value("threads").toInt(), stdout);
+    return failed > 0 ? 1 : 0;
+}
+
+// Renders one league's reveal to frames on the offscreen platform
+static int runExport(int argc, char *argv[])
+{
+    // Frames are painted into images, so no display is needed
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("draftlottery");
+    setApplicationFont(readFontResource());
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders a lottery reveal to PNG frames or a raw BGRA video stream.");
+    parser.addHelpOption();
+    parser.addOption({"export-reveal", "Frame directory, or a .raw file (- is stdout) for a raw stream.", "path"});
+    parser.addOption({"seed", "Lottery seed, as shown in the window's status bar. Random if not given.", "number"});
+    parser.addOption({"draw", "Draw number of the seed, as shown in the window's status bar.", "number", "0"});
+    parser.addOption({"league", "League to draw when the file has several.", "index", "0"});
+    parser.addOption({"weighted-order", "Draw every pick by odds instead of only the first overall pick."});
+    parser.addOption({"size", "Frame size in pixels.", "WIDTHxHEIGHT", "1920x1080"});
+    parser.addOption({"fps", "Frames per second of reveal time.", "rate", "60"});
+    parser.addOption({"threads", "Frames painted at the same time, 0 uses every core.", "count", "0"});
+    parser.addOption({"background", "Image drawn behind the reveal.", "file"});
+    parser.addOption({"trace", "Record the export and write it as Chrome trace JSON.", "file"});
+    parser.addPositionalArgument("file", "League file (JSON or CSV), - or nothing reads stdin.", "[file]");
+    parser.process(app);
+
+    quint64 seed = parser.isSet("seed") ? parser.value("seed").toULongLong() : QRandomGenerator::global()->generate64();
+    bool weightedOrder = parser.isSet("weighted-order");
+
+    BatchLottery leagues(seed, weightedOrder);
+    QString error;
+    QString file = parser.positionalArguments().value(0, "-");
+    if (!leagues.load(file, error))
+    {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 2;
+    }
+
+    int leagueIndex = parser.value("league").toInt();
+    if (leagueIndex < 0 || leagueIndex >= leagues.leagueCount())
+    {
+        std::fprintf(stderr, "%s has %d leagues\n", qPrintable(file), leagues.leagueCount());
+        return 2;
+    }
+
+    // The window only draws teams with odds
+    QVector<QPair<QString, int>> teams;
+    std::vector<std::int64_t> weights;
+    qint64 total = 0;
+    for (const auto &team : leagues.league(leagueIndex).teams)
+    {
+        if (team.second <= 0)
+            continue;
+        teams.append(team);
+        weights.push_back(team.second);
+        total += team.second;
+    }
+
+    if (total != TeamTableModel::fullOdds)
+    {
+        std::fprintf(stderr, "odds add up to %s, not 100%%\n", qPrintable(TeamTableModel::formatOdds(static_cast<int>(total))));
+        return 2;
+    }
+
+    // Same stream and draw as the window, so a seed and draw number export the lottery that was shown
+    quint64 draw = parser.value("draw").toULongLong();
+    Philox4x32 rng(seed, draw);
+    std::vector<int> order = drawDraftOrder(weights, weightedOrder, rng);
+    quint64 confettiSeed = rng();
+
+    RevealExporter::Settings settings;
+    QStringList size = parser.value("size").split('x');
+    settings.size = QSize(size.value(0).toInt(), size.value(1).toInt());
+    settings.fps = parser.value("fps").toInt();
+    settings.threads = parser.value("threads").toInt();
+    if (parser.isSet("background"))
+        settings.background = QImage(parser.value("background"));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (parser.isSet("trace"))
+    {
+        Tracer::setThreadName("export");
+        Tracer::start();
+    }
+
+    RevealExporter exporter(teams, QVector<int>(order.begin(), order.end()), confettiSeed);
+    if (!exporter.exportTo(parser.value("export-reveal"), settings, error))
+    {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+
+    if (parser.isSet("trace") && !writeTrace(parser.value("trace")))
+        return 1;
+
+    std::fprintf(stderr, "Seed %llu, draw %llu: %d frames (%d painted) in %.2f s\n", seed, draw,
+                 exporter.framesWritten(), exporter.framesPainted(), timer.elapsed() / 1000.0);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Batch and export modes have to be picked before any GUI object exists
+    bool profileStartup = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (qstrcmp(argv[i], "--batch") == 0)
+            return runBatch(argc, argv);
+        if (qstrcmp(argv[i], "--export-reveal") == 0)
+            return runExport(argc, argv);
+        if (qstrcmp(argv[i], "--profile-startup") == 0)
+            profileStartup = true;
+    }
+
+    StartupProfiler &profiler = StartupProfiler::instance();
+    profiler.start(profileStartup);
+
+    std::unique_ptr<QApplication> app;
+    {
+        StartupProfiler::Scope scope("QApplication");
+        app.reset(new QApplication(argc, argv));
+    }
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({"profile-startup", "Print how long each startup phase took, then exit."});
+    parser.addOption({"soak", "Run this many lotteries back to back and fail if memory grows.", "lotteries"});
+    parser.addOption({"soak-speed", "Reveal speed during --soak.", "multiplier", "50"});
+    parser.addOption({"soak-tolerance", "Heap growth allowed over a --soak run.", "KB", "256"});
+    parser.addOption({"trace", "Record the lottery pipeline and write it as Chrome trace JSON on exit.", "file"});
+    parser.addOption({"history", "Lottery history log to record to, instead of the one in the app data folder.", "file"});
+    parser.process(*app);
+
+    // Reading the font decompresses it out of the resources, that runs while the window is built
+    QByteArray fontData;
+    QThread *fontLoader = QThread::create([&fontData]()
+                                          {
+                                              StartupProfiler::Scope scope("font resource");
+                                              fontData = readFontResource();
+                                          });
+    fontLoader->start();
+
+    std::unique_ptr<MainWindow> w;
+    {
+        StartupProfiler::Scope scope("MainWindow");
+        w.reset(new MainWindow);
     }
 
-    MainWindow w;
-    w.show();
-    return a.exec();
+    {
+        // Set before the window is shown, so it is laid out once with the final font
+        StartupProfiler::Scope scope("font registration");
+        fontLoader->wait();
+        delete fontLoader;
+        setApplicationFont(fontData);
+    }
+
+    // Soak lotteries are only recorded when a log is given
+    if (parser.isSet("history"))
+        w->setHistoryPath(parser.value("history"));
+    else if (parser.isSet("soak"))
+        w->setHistoryPath(QString());
+
+    // Writes one CSV line per lottery to stdout and exits with the verdict
+    std::unique_ptr<SoakRunner> soak;
+    if (parser.isSet("soak"))
+    {
+        soak.reset(new SoakRunner(w.get(), parser.value("soak").toInt(), parser.value("soak-tolerance").toLongLong() * 1024, stdout));
+        soak->start(parser.value("soak-speed").toDouble());
+    }
+
+    if (parser.isSet("trace"))
+    {
+        Tracer::setThreadName("gui");
+        Tracer::start();
+    }
+
+    profiler.watchFirstPaint(w.get());
+    w->show();
+    int result = app->exec();
+
+    if (parser.isSet("trace") && !writeTrace(parser.value("trace")))
+        return result == 0 ? 1 : result;
+    return result;
 }
@@ -1,59 +1,127 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "broadcastserver.h"
+#include "cardrenderer.h"
+#include "confettioverlay.h"
+#include "confettisystem.h"
+#include "draftorder.h"
+#include "exactpickodds.h"
+#include "frametimehud.h"
+#include "historystore.h"
+#include "lotteryrules.h"
+#include "oddsexplorer.h"
+#include "pickoddsdialog.h"
+#include "philox.h"
+#include "pickoddssimulator.h"
+#include "revealcard.h"
+#include "revealtimeline.h"
+#include "startupprofiler.h"
+#include "teamimporter.h"
+#include "teamtablemodel.h"
+#include "tracer.h"
 
-#include <QLineEdit>
 #include <QHBoxLayout>
 #include <QMap>
 #include <QRandomGenerator>
 #include <QMessageBox>
-#include <QPropertyAnimation>
-#include <QSequentialAnimationGroup>
+#include <QNetworkInterface>
+#include <QActionGroup>
 #include <QTimer>
-#include <QGraphicsOpacityEffect>
-#include <QEventLoop>
 #include <QPainter>
+#include <QResizeEvent>
+#include <QMenuBar>
+#include <QThread>
+#include <QClipboard>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QGuiApplication>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QInputDialog>
+#include <QJsonObject>
+#include <QLineEdit>
+#include <QShortcut>
+#include <QSignalBlocker>
+#include <QStatusBar>
+#include <QStyledItemDelegate>
 
-// This class represents a single piece of confetti
-class ConfettiParticle
-{
-public:
-    QPointF position;
-    QPointF velocity;
-    QColor color;
-    double rotation;
-    double rotationSpeed;
-    double size;
+#include <algorithm>
+#include <memory>
 
-    ConfettiParticle(const QPointF &pos, const QPointF &vel, const QColor &col,
-                     double rot, double rotSpeed, double sz)
-        : position(pos), velocity(vel), color(col), rotation(rot),
-          rotationSpeed(rotSpeed), size(sz) {}
+// Number of leading picks shown next to each team's odds
+static const int exactOddsPicks = 4;
 
-    // Simulates confetti falling and spinning
-    void update()
-    {
-        position += velocity;
-        velocity.ry() += 0.1;
-        rotation += rotationSpeed;
-    }
+// Typing pause before the pick odds column is recomputed, so an edit only updates the running total
+static const int exactOddsDelay = 150;
+
+// Number of lotteries run by the pick odds simulation
+static const quint64 simulationTrials = 100000000;
+
+// Confetti pool size and how many pieces the winner reveal bursts out
+static const int confettiCapacity = 50000;
+static const int confettiBurst = 5000;
+
+// The reveal is laid out for a window this tall and scaled to the real height
+static const qreal revealSceneHeight = 768.0;
 
-    void draw(QPainter &painter) const
+// Distance of the "Drawing lottery..." box from the top, in scene units
+static const qreal drawingTop = 50.0;
+
+// Port the spectator server listens on, viewers open http://<this machine>:8765
+static const quint16 broadcastPort = 8765;
+
+namespace
+{
+    // Commits odds on every keystroke instead of when the editor closes, so the totals and the what-if map follow the typing
+    class LiveOddsDelegate : public QStyledItemDelegate
     {
-        painter.save();
-        painter.translate(position);
-        painter.rotate(rotation);
-        painter.setBrush(QBrush(color));
-        painter.setPen(Qt::NoPen);
-        painter.drawRect(-size / 2, -size / 2, size, size);
-        painter.restore();
-    }
-};
+    public:
+        using QStyledItemDelegate::QStyledItemDelegate;
+
+        QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const override
+        {
+            QWidget *editor = QStyledItemDelegate::createEditor(parent, option, index);
+            if (QLineEdit *line = qobject_cast<QLineEdit *>(editor))
+            {
+                LiveOddsDelegate *self = const_cast<LiveOddsDelegate *>(this);
+                connect(line, &QLineEdit::textEdited, self, [self, line]()
+                        { emit self->commitData(line); });
+            }
+            return editor;
+        }
+
+        // The view writes every committed value back into the editor, which would reformat the text being typed
+        void setEditorData(QWidget *editor, const QModelIndex &index) const override
+        {
+            QLineEdit *line = qobject_cast<QLineEdit *>(editor);
+            if (line && line->isModified())
+                return;
+            QStyledItemDelegate::setEditorData(editor, index);
+        }
+    };
+}
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), ui(new Ui::MainWindow), totalOddsLabel(nullptr)
+    : QMainWindow(parent), ui(new Ui::MainWindow), totalOddsLabel(nullptr), totalOddsComplete(false), simulateAction(nullptr), weightedOrderAction(nullptr),
+      oddsExplorerAction(nullptr), oddsExplorer(nullptr), exactOddsTimer(nullptr),
+      confetti(new ConfettiSystem(confettiCapacity)), confettiOverlay(nullptr), frameHud(nullptr),
+      teamModel(nullptr), teamImporter(nullptr), importReplacing(false), lotterySeed(QRandomGenerator::system()->generate64()), drawIndex(0), confettiSeed(0),
+      revealTimeline(nullptr), skipRevealAction(nullptr), drawingCard(nullptr), revealBackdrop(nullptr),
+      cardRenderer(nullptr), eliminationCard(nullptr), winnerCard(nullptr), preparedCardIndex(-1), shownCardIndex(-1),
+      confettiStart(0), confettiSteps(0), broadcastServer(nullptr), broadcastAction(nullptr), viewerCountLabel(nullptr),
+      kioskMode(false), history(new HistoryStore()),
+      historyPath(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/history.dlh")
 {
-    ui->setupUi(this);
-    this->setFixedSize(1024, 768);
+    {
+        StartupProfiler::Scope scope("setupUi");
+        ui->setupUi(this);
+    }
+    // The reveal scales with the window, so it can be maximized or go full screen on a projector
+    resize(1024, 768);
+    setMinimumSize(800, 600);
     setWindowTitle("YOFHL Draft Lottery");
     setWindowIcon(QIcon(":/resources/yofhllogo.png"));
 
@@ -66,18 +134,168 @@ MainWindow::MainWindow(QWidget *parent)
         totalFont.setBold(true);
         totalOddsLabel->setFont(totalFont);
         totalOddsLabel->setAlignment(Qt::AlignCenter);
+        totalOddsLabel->setStyleSheet("color: red;");
         ui->verticalLayout->addWidget(totalOddsLabel, 0, Qt::AlignHCenter);
     }
 
-    // Trying to apply this layout in designer is not working for some reason
-    if (!ui->teamListWidget->layout())
+    // The table only creates an editor for the cell being edited, so thousands of rows stay cheap
+    teamModel = new TeamTableModel(this);
+    ui->teamTableView->setModel(teamModel);
+    ui->teamTableView->setEditTriggers(QAbstractItemView::AllEditTriggers);
+    ui->teamTableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    ui->teamTableView->verticalHeader()->setDefaultSectionSize(36);
+    ui->teamTableView->horizontalHeader()->setSectionResizeMode(TeamTableModel::NameColumn, QHeaderView::Stretch);
+    ui->teamTableView->horizontalHeader()->setSectionResizeMode(TeamTableModel::OddsColumn, QHeaderView::Fixed);
+    ui->teamTableView->horizontalHeader()->setSectionResizeMode(TeamTableModel::PickOddsColumn, QHeaderView::Fixed);
+    ui->teamTableView->setColumnWidth(TeamTableModel::OddsColumn, 100);
+    ui->teamTableView->setColumnWidth(TeamTableModel::PickOddsColumn, 170);
+    ui->teamTableView->setItemDelegateForColumn(TeamTableModel::OddsColumn, new LiveOddsDelegate(ui->teamTableView));
+    connect(teamModel, &TeamTableModel::oddsChanged, this, &MainWindow::updateTotalOdds);
+
+    exactOddsTimer = new QTimer(this);
+    exactOddsTimer->setSingleShot(true);
+    exactOddsTimer->setInterval(exactOddsDelay);
+    connect(exactOddsTimer, &QTimer::timeout, this, &MainWindow::refreshExactOdds);
+
+    // Bulk imports are parsed on a worker thread and arrive in batches
+    teamImporter = new TeamImporter(this);
+    connect(teamImporter, &TeamImporter::batchReady, this, &MainWindow::appendImported);
+    connect(teamImporter, &TeamImporter::finished, this, &MainWindow::finishImport);
+    connect(teamImporter, &TeamImporter::failed, this, [this](const QString &message)
+            {
+        importReplacing = false;
+        ui->dsbTeamCount->setEnabled(true);
+        QMessageBox::warning(this, "Import Teams", message); });
+
+    // Pasting several lines into the table imports them as teams
+    QShortcut *pasteShortcut = new QShortcut(QKeySequence::Paste, ui->teamTableView, nullptr, nullptr, Qt::WidgetShortcut);
+    connect(pasteShortcut, &QShortcut::activated, this, [this]()
+            { startImport(QString(), QGuiApplication::clipboard()->text()); });
+
+    // One overlay is kept around and reused for every reveal
+    confettiOverlay = new ConfettiOverlay(confetti, this);
+    confettiOverlay->hide();
+
+    frameHud = new FrameTimingHud(this);
+    frameHud->watchPaint(confettiOverlay, "Confetti");
+    frameHud->watchLayout(this, "Layout");
+    frameHud->watchLayout(ui->teamTableView, "Layout");
+
+    // A still of the window sits under the reveal, so a moving card only uncovers a cached image
+    revealBackdrop = new RevealCard(this);
+    revealBackdrop->setAttribute(Qt::WA_OpaquePaintEvent);
+    revealBackdrop->hide();
+
+    // Pooled cards show every status line, elimination and winner, their images come from the renderer
+    drawingCard = new RevealCard(this);
+    drawingCard->hide();
+    eliminationCard = new RevealCard(this);
+    eliminationCard->hide();
+    winnerCard = new RevealCard(this);
+    winnerCard->hide();
+    frameHud->watchPaint(eliminationCard, "Elimination");
+    frameHud->watchPaint(winnerCard, "Winner drop");
+
+    // Created once the window is up, after main() has registered the app font,
+    // and the card glyphs are rasterized then instead of during the first card
+    QTimer::singleShot(0, this, [this]()
+                       {
+        cardRenderer = new CardRenderer();
+        cardRenderer->setDevicePixelRatio(devicePixelRatioF());
+        cardRenderer->setScale(revealScale());
+        cardRenderer->warmUp(); });
+
+    // One clock drives every step of the reveal
+    revealTimeline = new RevealTimeline(this);
+    connect(revealTimeline, &RevealTimeline::stepStarted, this, &MainWindow::revealStepStarted);
+    connect(revealTimeline, &RevealTimeline::frame, this, &MainWindow::revealFrame);
+    connect(revealTimeline, &RevealTimeline::finished, this, &MainWindow::finishReveal);
+    frameHud->watchTimer(revealTimeline->frameTimer(), "Reveal");
+
+    QMenu *toolsMenu = menuBar()->addMenu("Tools");
+    QAction *importAction = toolsMenu->addAction("Import Teams...");
+    connect(importAction, &QAction::triggered, this, [this]()
+            {
+        QString path = QFileDialog::getOpenFileName(this, "Import Teams", QString(), "Team lists (*.csv *.txt);;All files (*)");
+        if (!path.isEmpty())
+            startImport(path, QString()); });
+
+    // Sets the seed and draw number the next lottery uses, to reproduce an earlier draw
+    QAction *replayAction = toolsMenu->addAction("Replay Draw...");
+    connect(replayAction, &QAction::triggered, this, [this]()
+            {
+        bool ok = false;
+        QString text = QInputDialog::getText(this, "Replay Draw", "Seed and draw number (seed:draw):", QLineEdit::Normal,
+                                             QString("%1:%2").arg(lotterySeed).arg(drawIndex), &ok);
+        if (!ok)
+            return;
+
+        QStringList parts = text.split(':');
+        bool seedOk = false;
+        bool drawOk = false;
+        quint64 seed = parts.value(0).trimmed().toULongLong(&seedOk);
+        quint64 draw = parts.value(1).trimmed().toULongLong(&drawOk);
+        if (parts.size() != 2 || !seedOk || !drawOk)
+        {
+            QMessageBox::warning(this, "Replay Draw", "Enter the seed and draw number as seed:draw.");
+            return;
+        }
+
+        lotterySeed = seed;
+        drawIndex = draw;
+        statusBar()->showMessage(QString("Next lottery replays seed %1, draw %2").arg(lotterySeed).arg(drawIndex)); });
+
+    QAction *historyAction = toolsMenu->addAction("Lottery History...");
+    connect(historyAction, &QAction::triggered, this, &MainWindow::showHistory);
+
+    simulateAction = toolsMenu->addAction("Simulate Pick Odds...");
+    connect(simulateAction, &QAction::triggered, this, &MainWindow::simulatePickOdds);
+
+    // Draws every pick by odds instead of only the first overall pick
+    weightedOrderAction = toolsMenu->addAction("Weighted Draft Order");
+    weightedOrderAction->setCheckable(true);
+    connect(weightedOrderAction, &QAction::toggled, this, &MainWindow::updatePickOdds);
+
+    // Live team x pick odds while the odds are being edited
+    oddsExplorerAction = toolsMenu->addAction("What-If Odds");
+    oddsExplorerAction->setCheckable(true);
+    connect(oddsExplorerAction, &QAction::toggled, this, &MainWindow::setOddsExplorerVisible);
+
+    // Reveal playback speed, the draw itself is unaffected
+    QMenu *speedMenu = toolsMenu->addMenu("Reveal Speed");
+    QActionGroup *speedGroup = new QActionGroup(speedMenu);
+    for (double speed : {0.5, 1.0, 2.0, 4.0})
     {
-        QVBoxLayout *layout = new QVBoxLayout(ui->teamListWidget);
-        layout->setSpacing(2);
-        layout->setContentsMargins(4, 4, 4, 4);
-        ui->teamListWidget->setLayout(layout);
+        QAction *speedAction = speedMenu->addAction(QString("%1x").arg(speed));
+        speedAction->setCheckable(true);
+        speedAction->setChecked(speed == 1.0);
+        speedGroup->addAction(speedAction);
+        connect(speedAction, &QAction::triggered, this, [this, speed]()
+                { revealTimeline->setSpeed(speed); });
     }
 
+    QAction *fullScreenAction = toolsMenu->addAction("Full Screen");
+    fullScreenAction->setCheckable(true);
+    fullScreenAction->setShortcut(Qt::Key_F11);
+    connect(fullScreenAction, &QAction::toggled, this, [this](bool enabled)
+            { enabled ? showFullScreen() : showNormal(); });
+
+    skipRevealAction = toolsMenu->addAction("Skip to Result");
+    skipRevealAction->setShortcut(Qt::Key_Escape);
+    skipRevealAction->setEnabled(false);
+    connect(skipRevealAction, &QAction::triggered, revealTimeline, &RevealTimeline::skipToEnd);
+
+    // Streams the reveal to phones and second screens on the local network
+    broadcastAction = toolsMenu->addAction("Broadcast to Viewers");
+    broadcastAction->setCheckable(true);
+    connect(broadcastAction, &QAction::toggled, this, &MainWindow::setBroadcasting);
+
+    // Frame timing overlay for spotting stutter without a profiler
+    QAction *frameHudAction = toolsMenu->addAction("Show Frame Timing");
+    frameHudAction->setCheckable(true);
+    frameHudAction->setShortcut(Qt::Key_F3);
+    connect(frameHudAction, &QAction::toggled, frameHud, &FrameTimingHud::setActive);
+
     // Initialize team inputs
     updateTeamInputs(static_cast<int>(ui->dsbTeamCount->value()));
 }
@@ -85,34 +303,83 @@ MainWindow::MainWindow(QWidget *parent)
 // Destructor for MainWindow, cleans up the UI
 MainWindow::~MainWindow()
 {
+    delete broadcastServer;
+    delete confetti;
+    delete cardRenderer;
+    delete history;
     delete ui;
 }
 
 // Updates the total odds label which controls the button state
 void MainWindow::updateTotalOdds()
 {
-    int total = 0;
-    for (QLineEdit *edit : oddsInputs)
+    qint64 total = teamModel->totalOdds();
+    bool complete = total == TeamTableModel::fullOdds;
+
+    totalOddsLabel->setText(QString("Total Odds: %1").arg(TeamTableModel::formatOdds(static_cast<int>(total))));
+
+    // Green if 100%, red otherwise. Setting a style sheet re-polishes the label, so only do it when the state flips
+    if (complete != totalOddsComplete)
     {
-        bool ok;
-        int val = edit->text().toInt(&ok);
-        if (ok)
-            total += val;
+        totalOddsComplete = complete;
+        totalOddsLabel->setStyleSheet(complete ? "color: green;" : "color: red;");
     }
 
-    totalOddsLabel->setText(QString("Total Odds: %1%").arg(total));
+    ui->btnDoLottery->setEnabled(complete);
 
-    // Green if 100%, red otherwise
-    if (total == 100)
+    updatePickOdds();
+}
+
+// Schedules the pick odds column and feeds the what-if explorer when it is open
+void MainWindow::updatePickOdds()
+{
+    exactOddsTimer->start();
+
+    if (oddsExplorer && oddsExplorer->isVisible())
     {
-        totalOddsLabel->setStyleSheet("color: green;");
+        QStringList names;
+        std::vector<std::int64_t> explorerWeights;
+        for (const auto &team : collectTeams())
+        {
+            names.append(team.first);
+            explorerWeights.push_back(team.second);
+        }
+        oddsExplorer->setTeams(names, explorerWeights, weightedOrderAction->isChecked());
     }
-    else
+}
+
+// Shows every team's exact chance of landing in the first few picks next to its odds
+void MainWindow::refreshExactOdds()
+{
+    std::vector<std::int64_t> weights = teamModel->weights();
+
+    int picks = std::min(exactOddsPicks, static_cast<int>(weights.size()));
+    ExactPickOdds odds = weightedOrderAction->isChecked() ? ExactPickOdds::weightedOrder(weights, picks)
+                                                          : ExactPickOdds::winnerThenShuffle(weights, picks);
+    teamModel->setPickOdds(odds);
+}
+
+// Opens the what-if explorer on the current odds, it follows every edit while open
+void MainWindow::setOddsExplorerVisible(bool visible)
+{
+    if (!visible)
     {
-        totalOddsLabel->setStyleSheet("color: red;");
+        if (oddsExplorer)
+            oddsExplorer->close();
+        return;
     }
 
-    ui->btnDoLottery->setEnabled(total == 100);
+    if (!oddsExplorer)
+    {
+        oddsExplorer = new OddsExplorer(this);
+        connect(oddsExplorer, &OddsExplorer::closed, this, [this]()
+                {
+            QSignalBlocker blocker(oddsExplorerAction);
+            oddsExplorerAction->setChecked(false); });
+    }
+    oddsExplorer->show();
+    oddsExplorer->raise();
+    updatePickOdds();
 }
 
 // Called whenever the number in the double spinner box changes to update the team inputs
@@ -121,480 +388,602 @@ void MainWindow::on_dsbTeamCount_valueChanged(double arg1)
     updateTeamInputs(static_cast<int>(arg1));
 }
 
-// Handles custom painting for the confetti overlay
-bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+// Updates the team inputs based on the number of teams specified in the spinner box
+void MainWindow::updateTeamInputs(int count)
 {
-    // Draw confetti particles when its a paint event and the watched object had the confetti property
-    if (event->type() == QEvent::Paint)
+    // The model keeps existing names and odds when rows are added or removed
+    teamModel->setRowCount(count);
+}
+
+// Replaces the team list with teams parsed from a file or pasted text
+void MainWindow::startImport(const QString &path, const QString &text)
+{
+    if (path.isEmpty() && !text.contains('\n') && !text.contains(',') && !text.contains('\t'))
+        return;
+
+    // Cleared by the first batch, so text without a single team leaves the list alone
+    importReplacing = true;
+    ui->dsbTeamCount->setEnabled(false);
+
+    if (path.isEmpty())
+        teamImporter->importText(text);
+    else
+        teamImporter->importFile(path);
+}
+
+// Adds an imported batch, replacing the old team list with the first one
+void MainWindow::appendImported(const QVector<TeamTableModel::Team> &teams)
+{
+    if (importReplacing)
     {
-        QWidget *widget = qobject_cast<QWidget *>(watched);
-        if (widget && widget->property("confetti").toBool())
-        {
-            QPainter painter(widget);
-            painter.setRenderHint(QPainter::Antialiasing);
+        teamModel->clear();
+        importReplacing = false;
+    }
+    teamModel->appendTeams(teams);
+}
 
-            QVariant var = widget->property("confettiParticles");
-            QList<ConfettiParticle> *confetti = static_cast<QList<ConfettiParticle> *>(var.value<void *>());
+// Syncs the team count spinner with the imported rows
+void MainWindow::finishImport(int imported, int skipped)
+{
+    if (importReplacing)
+    {
+        importReplacing = false;
+        ui->dsbTeamCount->setEnabled(true);
+        statusBar()->showMessage(QString("No teams found, %1 lines without odds skipped, the team list was kept").arg(skipped), 5000);
+        return;
+    }
 
-            if (confetti)
-            {
-                for (const auto &particle : *confetti)
-                {
-                    particle.draw(painter);
-                }
-            }
-            return true;
-        }
+    {
+        QSignalBlocker blocker(ui->dsbTeamCount);
+        ui->dsbTeamCount->setValue(teamModel->rowCount());
+    }
+    ui->dsbTeamCount->setEnabled(true);
+
+    if (skipped > 0)
+    {
+        statusBar()->showMessage(QString("Imported %1 teams, skipped %2 lines without odds").arg(imported).arg(skipped), 5000);
     }
-    return QMainWindow::eventFilter(watched, event);
 }
 
-// Updates the team inputs based on the number of teams specified in the spinner box
-void MainWindow::updateTeamInputs(int count)
+// Sets up the reveal for a drawn order and starts its timeline
+void MainWindow::startReveal(const QVector<QPair<QString, int>> &teams, const QVector<int> &draftOrder)
+{
+    revealWinner = teams[draftOrder.first()];
+
+    // The team drafting last is eliminated first
+    revealEliminations.clear();
+    for (int i = draftOrder.size() - 1; i > 0; --i)
+    {
+        revealEliminations.append(teams[draftOrder[i]]);
+    }
+
+    TRACE_COUNTER(Tracer::Reveal, "eliminations", revealEliminations.size());
+
+    // Only the first card is rendered up front, each later one while the card before it holds still
+    preparedCardIndex = -1;
+    shownCardIndex = -1;
+    prepareEliminationCard(0);
+    winnerCard->setImage(cardRenderer->winnerCard(revealWinner.first, revealWinner.second));
+    drawingCard->setImage(cardRenderer->labelCard("Drawing lottery..."));
+
+    revealBackdrop->setGeometry(centralWidget()->geometry());
+    revealBackdrop->setImage(centralWidget()->grab().toImage());
+    revealBackdrop->show();
+    revealBackdrop->raise();
+    frameHud->raise();
+
+    broadcast("start", revealWinner);
+
+    skipRevealAction->setEnabled(true);
+    revealTimeline->setEliminations(revealEliminations.size());
+    revealTimeline->start();
+}
+
+// Renders an elimination card ahead of its slide in
+void MainWindow::prepareEliminationCard(int elimination)
 {
-    QLayout *layout = ui->teamListWidget->layout();
+    if (elimination >= revealEliminations.size())
+        return;
+
+    TRACE_SCOPE(Tracer::Reveal, "renderCard");
+    const QPair<QString, int> &team = revealEliminations[elimination];
+    preparedCard = cardRenderer->eliminationCard(team.first, team.second);
+    preparedCardIndex = elimination;
+}
+
+// Logical pixels per scene unit, cards and confetti are rasterized at this scale rather than stretched
+qreal MainWindow::revealScale() const
+{
+    return std::max(0.5, height() / revealSceneHeight);
+}
+
+// The window in scene units, the confetti physics works in these
+QSizeF MainWindow::revealScene() const
+{
+    return QSizeF(size()) / revealScale();
+}
+
+// Re-rasterizes whatever the reveal shows at the new scale, positions follow on the next frame
+void MainWindow::resizeEvent(QResizeEvent *event)
+{
+    QMainWindow::resizeEvent(event);
+
+    if (!cardRenderer || qFuzzyCompare(cardRenderer->scale(), revealScale()))
+        return;
+    cardRenderer->setScale(revealScale());
+
+    if (!revealTimeline->isRunning())
+        return;
 
-    // Number of inputs before the update
-    int currentCount = oddsInputs.size();
+    drawingCard->setImage(cardRenderer->labelCard("Drawing lottery..."));
+    drawingCard->move((width() - drawingCard->width()) / 2, qRound(drawingTop * revealScale()));
+    winnerCard->setImage(cardRenderer->winnerCard(revealWinner.first, revealWinner.second));
 
-    // Logic to preserve existing data in the inputs
-    if (count > currentCount)
+    if (shownCardIndex >= 0)
     {
-        // Add new inputs if the team count increases
-        for (int i = currentCount; i < count; ++i)
-        {
-            QHBoxLayout *rowLayout = new QHBoxLayout;
-
-            QLineEdit *nameEdit = new QLineEdit;
-            nameEdit->setPlaceholderText(QString("Team %1 Name").arg(i + 1));
-            nameEdit->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
-            nameEdit->setAlignment(Qt::AlignCenter);
-            nameEdit->setMinimumHeight(30);
-            QFont nameFont;
-            nameFont.setPointSize(12);
-            nameEdit->setFont(nameFont);
-
-            QLineEdit *oddsEdit = new QLineEdit;
-            oddsEdit->setPlaceholderText("Odds");
-            oddsEdit->setFixedWidth(75);
-            oddsEdit->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Preferred);
-            oddsEdit->setAlignment(Qt::AlignCenter);
-            oddsEdit->setMinimumHeight(30);
-            QFont oddsFont;
-            oddsFont.setPointSize(12);
-            oddsFont.setBold(true);
-            oddsEdit->setFont(oddsFont);
-
-            QLabel *percentLabel = new QLabel("%");
-            percentLabel->setMinimumHeight(30);
-            percentLabel->setAlignment(Qt::AlignVCenter | Qt::AlignLeft);
-            QFont percentFont;
-            percentFont.setPointSize(12);
-            percentFont.setBold(true);
-            percentLabel->setFont(percentFont);
-
-            connect(oddsEdit, &QLineEdit::textChanged, this, &MainWindow::updateTotalOdds);
-            oddsInputs.append(oddsEdit);
-
-            rowLayout->addWidget(nameEdit);
-            rowLayout->addWidget(oddsEdit);
-            rowLayout->addWidget(percentLabel);
-
-            QWidget *container = new QWidget;
-            container->setLayout(rowLayout);
-
-            layout->addWidget(container);
-        }
+        const QPair<QString, int> &team = revealEliminations[shownCardIndex];
+        eliminationCard->setImage(cardRenderer->eliminationCard(team.first, team.second));
     }
-    // Remove extra inputs if the team count decreases
-    else if (count < currentCount)
+    prepareEliminationCard(shownCardIndex + 1);
+
+    revealBackdrop->setGeometry(centralWidget()->geometry());
+    revealBackdrop->setImage(centralWidget()->grab().toImage());
+
+    QSizeF scene = revealScene();
+    confetti->setBounds(scene.width(), scene.height());
+    confettiOverlay->setGeometry(0, 0, width(), height());
+    confettiOverlay->setSceneScale(revealScale());
+}
+
+// Puts up the widgets a step needs, positions are set by revealFrame
+void MainWindow::revealStepStarted(const RevealTimeline::Step &step)
+{
+    TRACE_SCOPE(Tracer::Reveal, "revealStep");
+    TRACE_INSTANT(Tracer::Reveal, "phase", static_cast<int>(step.phase));
+
+    switch (step.phase)
     {
-        for (int i = currentCount - 1; i >= count; --i)
-        {
-            QLayoutItem *child = layout->itemAt(i);
-            if (child)
-            {
-                QWidget *widget = child->widget();
-                if (widget)
-                {
-                    layout->removeItem(child);
-                    delete widget;
-                }
-                delete child;
-            }
+    case RevealTimeline::Phase::Drawing:
+    {
+        drawingCard->move((width() - drawingCard->width()) / 2, qRound(drawingTop * revealScale()));
+        drawingCard->raise();
+        drawingCard->show();
+        break;
+    }
 
-            if (i < oddsInputs.size())
-            {
-                oddsInputs.removeAt(i);
-            }
-        }
+    case RevealTimeline::Phase::SlideIn:
+    {
+        drawingCard->hide();
+
+        const QPair<QString, int> &team = revealEliminations[step.elimination];
+        // The winner isn't in revealEliminations, so the first team eliminated makes the last pick
+        int pick = revealEliminations.size() - step.elimination + 1;
+        TRACE_INSTANT(Tracer::Reveal, "elimination", pick);
+        broadcast("elimination", team, pick);
+
+        // The card was rendered while the previous one held still, the next one waits for this one's hold
+        eliminationCard->setImage(preparedCardIndex == step.elimination ? preparedCard
+                                                                         : cardRenderer->eliminationCard(team.first, team.second));
+        shownCardIndex = step.elimination;
+
+        eliminationCard->move(RevealTimeline::cardPosition(step, 0.0, size(), eliminationCard->size()).toPoint());
+        eliminationCard->show();
+        eliminationCard->raise();
+        break;
     }
 
-    // Retain existing input data
-    for (int i = 0; i < count; ++i)
+    case RevealTimeline::Phase::Hold:
+        // Nothing moves during the hold, so rendering here can't delay a slide frame
+        if (preparedCardIndex != step.elimination + 1)
+            prepareEliminationCard(step.elimination + 1);
+        break;
+
+    case RevealTimeline::Phase::Gap:
+        eliminationCard->hide();
+        break;
+
+    case RevealTimeline::Phase::WinnerDrop:
     {
-        QLineEdit *oddsEdit = oddsInputs[i];
-        QLineEdit *nameEdit = qobject_cast<QLineEdit *>(oddsEdit->parentWidget()->layout()->itemAt(0)->widget());
+        drawingCard->hide();
+        broadcast("winner", revealWinner, 1);
+
+        winnerCard->move(RevealTimeline::cardPosition(step, 0.0, size(), winnerCard->size()).toPoint());
+        winnerCard->show();
+        winnerCard->raise();
+
+        // Reuse the pooled particle arrays, the burst starts moving upwards then falls with gravity.
+        // The particles move in scene units, so the burst looks the same at any window size.
+        QSizeF scene = revealScene();
+        confetti->reset();
+        confetti->setSeed(confettiSeed);
+        confetti->setBounds(scene.width(), scene.height());
+        confetti->burst(scene.width() / 2, scene.height() / 3, confettiBurst);
+
+        confettiOverlay->setGeometry(0, 0, width(), height());
+        confettiOverlay->setSceneScale(revealScale());
+        confettiOverlay->clear();
+        break;
+    }
 
-        oddsEdit->setText(oddsEdit->text());
-        nameEdit->setText(nameEdit->text());
+    case RevealTimeline::Phase::WinnerHold:
+    {
+        // Keep recycling fallen confetti while the winner is on screen
+        confetti->setEmitter(revealScene().width() / 2, revealScene().height() / 3, true);
+        confettiOverlay->show();
+        confettiOverlay->raise();
+        confettiStart = step.start;
+        confettiSteps = 0;
+        break;
     }
 
-    updateTotalOdds();
+    default:
+        break;
+    }
 }
 
-// Shows the winner animation with confetti and a message, plays after the elimination sequence
-void MainWindow::showWinnerAnimation(const QString &winnerName, int winnerOdds)
+// Positions the reveal widgets for the current point of the active step
+void MainWindow::revealFrame(const RevealTimeline::Step &step, qreal progress)
 {
-    // Label styling
-    QLabel *winLabel = new QLabel(this);
-    winLabel->setText(QString("<h1 style='color:gold; font-size:36pt; text-align:center; text-shadow: 2px 2px 4px black;'>%1</h1>"
-                              "<h3 style='text-align:center;'>Won with %2% odds!</h3>")
-                          .arg(winnerName)
-                          .arg(winnerOdds));
+    TRACE_SCOPE(Tracer::Frame, "revealFrame");
 
-    winLabel->setAlignment(Qt::AlignCenter);
-    winLabel->setStyleSheet("background-color: rgba(30, 30, 30, 240); border: 2px solid gold; border-radius: 15px; padding: 20px; color: white;");
-    winLabel->setFixedSize(700, 300);
+    switch (step.phase)
+    {
+    case RevealTimeline::Phase::SlideIn:
+    case RevealTimeline::Phase::SlideOut:
+        eliminationCard->move(RevealTimeline::cardPosition(step, progress, size(), eliminationCard->size()).toPoint());
+        break;
 
-    // Center the label off screen
-    winLabel->move((width() - winLabel->width()) / 2, -winLabel->height());
-    winLabel->show();
-    winLabel->raise();
+    case RevealTimeline::Phase::WinnerDrop:
+        winnerCard->move(RevealTimeline::cardPosition(step, progress, size(), winnerCard->size()).toPoint());
+        break;
 
-    qApp->processEvents();
+    case RevealTimeline::Phase::WinnerFade:
+    {
+        winnerCard->setOpacity(RevealTimeline::cardOpacity(step, progress));
+        advanceConfetti();
+        break;
+    }
 
-    // Drop the label into the center of the screen
-    QPropertyAnimation *dropAnim = new QPropertyAnimation(winLabel, "geometry");
-    dropAnim->setDuration(1200);
-    dropAnim->setStartValue(QRect((width() - winLabel->width()) / 2,
-                                  -winLabel->height(),
-                                  winLabel->width(),
-                                  winLabel->height()));
-    dropAnim->setEndValue(QRect((width() - winLabel->width()) / 2,
-                                (height() - winLabel->height()) / 2,
-                                winLabel->width(),
-                                winLabel->height()));
-    dropAnim->setEasingCurve(QEasingCurve::OutBounce);
+    case RevealTimeline::Phase::WinnerHold:
+        advanceConfetti();
+        break;
 
-    // Create confetti overlay
-    QWidget *confettiOverlay = new QWidget(this);
-    confettiOverlay->setGeometry(0, 0, width(), height());
-    confettiOverlay->setAttribute(Qt::WA_TransparentForMouseEvents);
-    confettiOverlay->setStyleSheet("background-color: transparent;");
-
-    // Generate confetti particles
-    QList<ConfettiParticle> *confetti = new QList<ConfettiParticle>();
-    QStringList colors = {"#ffd700", "#ff0000", "#00ff00", "#0000ff", "#ff00ff", "#00ffff", "#ff8000"};
-    QRandomGenerator rng = QRandomGenerator::securelySeeded();
-
-    // Generate 150 confetti particles with random properties
-    // Initially move upwards, then fall down simulating gravity
-    for (int i = 0; i < 150; i++)
-    {
-        QPointF pos(width() / 2, height() / 3);
-        double angle = rng.bounded(2 * M_PI);
-        double speed = 1.0 + (rng.generateDouble() * 4.0);         // Range 1 - 5
-        QPointF vel(speed * cos(angle), speed * sin(angle) - 3.0); // Initial upward velocity
-        QColor color(colors.at(rng.bounded(colors.size())));
-        double rotation = rng.bounded(360.0);
-        double rotSpeed = -5.0 + (rng.generateDouble() * 10.0); // Range -5-5
-        double size = 5.0 + (rng.generateDouble() * 10.0);      // Range 5-15
-
-        confetti->append(ConfettiParticle(pos, vel, color, rotation, rotSpeed, size));
-    }
-
-    // Set properties to the overlay widget for the event filter
-    confettiOverlay->setProperty("confetti", true);
-    confettiOverlay->setProperty("confettiParticles", QVariant::fromValue(static_cast<void *>(confetti)));
-    confettiOverlay->installEventFilter(this);
-
-    // Timer for confetti animation
-    QTimer *confettiTimer = new QTimer(this);
-    connect(confettiTimer, &QTimer::timeout, [confettiOverlay, confetti]()
-            {
-       for (auto &particle : *confetti) {
-           particle.update();
-       }
-       confettiOverlay->update(); });
+    default:
+        break;
+    }
+}
 
-    QSequentialAnimationGroup *animGroup = new QSequentialAnimationGroup(this);
-    animGroup->addAnimation(dropAnim);
+// Steps the confetti physics in fixed 16 ms steps to catch up with the timeline
+void MainWindow::advanceConfetti()
+{
+    // At high reveal speeds only a few steps are run per frame so the frame stays short
+    const int maxStepsPerFrame = 4;
 
-    // Start confetti after the drop animation finishes
-    connect(dropAnim, &QPropertyAnimation::finished, [confettiOverlay, confettiTimer, confetti]()
-            {
-                confettiOverlay->show();
-                confettiOverlay->raise();
-                confettiTimer->start(16); });
-    animGroup->addPause(3000);
-
-    // Fade out the confetti
-    QGraphicsOpacityEffect *opacityEffect = new QGraphicsOpacityEffect(winLabel);
-    winLabel->setGraphicsEffect(opacityEffect);
-    opacityEffect->setOpacity(1.0);
-
-    QPropertyAnimation *fadeAnim = new QPropertyAnimation(opacityEffect, "opacity");
-    fadeAnim->setDuration(800);
-    fadeAnim->setStartValue(1.0);
-    fadeAnim->setEndValue(0.0);
-    fadeAnim->setEasingCurve(QEasingCurve::InQuad);
-    animGroup->addAnimation(fadeAnim);
-
-    // Clean up when animation finishes
-    connect(animGroup, &QSequentialAnimationGroup::finished, this, [winLabel, confettiOverlay, confettiTimer, confetti]()
-            {
-        confettiTimer->stop();
-        delete confetti;
-        confettiOverlay->deleteLater();
-        winLabel->deleteLater(); });
+    TRACE_SCOPE(Tracer::Frame, "advanceConfetti");
 
-    animGroup->start(QAbstractAnimation::DeleteWhenStopped);
+    qint64 due = (revealTimeline->elapsed() - confettiStart) / 16;
+    qint64 steps = std::min<qint64>(due - confettiSteps, maxStepsPerFrame);
+    for (qint64 i = 0; i < steps; ++i)
+    {
+        confetti->update();
+    }
+    confettiSteps = due;
+    confettiOverlay->advance();
+    TRACE_COUNTER(Tracer::Frame, "confettiSteps", steps);
 }
 
-// Wliminates teams recursively, showing animations for each elimination
-void MainWindow::eliminateNextTeam(const QVector<QPair<QString, int>> &teams, int currentIndex, int totalTeams, const QString &winnerName, int winnerOdds)
+// Clears the reveal off the screen and announces the winner, also reached by skipping
+void MainWindow::finishReveal()
 {
-    qDebug() << "Inside eliminateNextTeam - Current index:" << currentIndex << "of" << teams.size();
+    TRACE_INSTANT(Tracer::Reveal, "finishReveal", revealTimeline->elapsed());
+    skipRevealAction->setEnabled(false);
 
-    // If we've eliminated all teams, show the winner
-    if (currentIndex >= teams.size())
+    drawingCard->hide();
+    eliminationCard->hide();
+    winnerCard->hide();
+    revealBackdrop->hide();
+
+    confetti->reset();
+    confettiOverlay->hide();
+
+    // Viewers get the winner even when the reveal was skipped
+    broadcast("finished", revealWinner, 1);
+
+    // An unattended display goes straight on to the next lottery
+    if (kioskMode)
     {
-        qDebug() << "All teams eliminated, now showing winner:" << winnerName;
-        showWinnerAnimation(winnerName, winnerOdds);
+        statusBar()->showMessage(QString("Winner: %1 with %2 odds").arg(revealWinner.first, TeamTableModel::formatOdds(revealWinner.second)));
+        ui->btnDoLottery->setEnabled(true);
+        emit lotteryFinished();
         return;
     }
 
-    QString teamName = teams[currentIndex].first;
-    int odds = teams[currentIndex].second;
-    int position = totalTeams - currentIndex;
+    QMessageBox winnerBox(this);
+    winnerBox.setWindowTitle("WE HAVE A WINNER!");
 
-    qDebug() << "Eliminating team:" << teamName << "Position:" << position << "Odds:" << odds;
+    QString winnerMessage = "<h2>Congratulations to:</h2>";
+    winnerMessage += QString("<h1 style='color:gold; font-size: 24pt;'>%1!</h1>")
+                         .arg(revealWinner.first);
+    winnerMessage += QString("<p>who will draft first overall. They had a <b>%1 chance</b> of winning.</p>")
+                         .arg(TeamTableModel::formatOdds(revealWinner.second));
 
-    showTeamElimination(teamName, position, odds, [this, teams, currentIndex, totalTeams, winnerName, winnerOdds]()
-                        {
-qDebug() << "Elimination animation complete for team at index:" << currentIndex;
+    winnerBox.setText(winnerMessage);
+    winnerBox.exec();
 
-// Slight delay before showing next team
-QTimer::singleShot(800, this, [this, teams, currentIndex, totalTeams, winnerName, winnerOdds]() {
-eliminateNextTeam(teams, currentIndex + 1, totalTeams, winnerName, winnerOdds);
-}); });
+    // Re-enable lottery button
+    ui->btnDoLottery->setEnabled(true);
+    emit lotteryFinished();
 }
 
-// Starts elimination animation sequence after the lottery winner is determined
-void MainWindow::startEliminationSequence(const QVector<QPair<QString, int>> &teams, int winnerIndex)
+// Starts or stops the spectator server
+void MainWindow::setBroadcasting(bool enabled)
 {
-    qDebug() << "Inside startEliminationSequence - Winner index:" << winnerIndex;
+    if (!enabled)
+    {
+        if (broadcastServer)
+            broadcastServer->stop();
+        if (viewerCountLabel)
+            viewerCountLabel->hide();
+        return;
+    }
 
-    QString winnerTeamName = teams[winnerIndex].first;
-    int winnerTeamOdds = teams[winnerIndex].second;
+    if (!broadcastServer)
+    {
+        broadcastServer = new BroadcastServer();
+        viewerCountLabel = new QLabel(this);
+        statusBar()->addPermanentWidget(viewerCountLabel);
+        connect(broadcastServer, &BroadcastServer::clientCountChanged, viewerCountLabel, [this](int count)
+                { viewerCountLabel->setText(QString("Viewers: %1").arg(count)); }, Qt::QueuedConnection);
+    }
 
-    qDebug() << "Winner in elimination:" << winnerTeamName;
+    QString error;
+    if (!broadcastServer->start(broadcastPort, error))
+    {
+        QSignalBlocker blocker(broadcastAction);
+        broadcastAction->setChecked(false);
+        QMessageBox::warning(this, "Broadcast to Viewers", QString("Could not listen on port %1: %2").arg(broadcastPort).arg(error));
+        return;
+    }
 
-    // Create a list of teams to eliminate (everyone except the winner)
-    QVector<QPair<QString, int>> teamsToEliminate;
-    for (int i = 0; i < teams.size(); ++i)
+    // The first LAN address is the one to put on the venue screen
+    QString host = "localhost";
+    for (const QHostAddress &address : QNetworkInterface::allAddresses())
     {
-        if (i != winnerIndex)
+        if (address.protocol() == QAbstractSocket::IPv4Protocol && !address.isLoopback())
         {
-            teamsToEliminate.append(teams[i]);
+            host = address.toString();
+            break;
         }
     }
 
-    qDebug() << "Teams to eliminate count:" << teamsToEliminate.size();
+    viewerCountLabel->setText("Viewers: 0");
+    viewerCountLabel->show();
+    statusBar()->showMessage(QString("Viewers can follow the lottery at http://%1:%2").arg(host).arg(broadcastPort));
+}
+
+// Sends a reveal event to the spectators, encoding happens here and the fan-out on the server thread
+void MainWindow::broadcast(const QString &type, const QPair<QString, int> &team, int pick)
+{
+    if (!broadcastServer || !broadcastServer->isRunning())
+        return;
 
-    // Randomize the order in which teams are eliminated
-    std::random_device rd;
-    QRandomGenerator rng(rd());
-    for (int i = teamsToEliminate.size() - 1; i > 0; --i)
+    QJsonObject event;
+    event["type"] = type;
+    if (type == "start")
     {
-        int j = rng.bounded(i + 1);
-        teamsToEliminate.swapItemsAt(i, j);
+        event["teams"] = revealEliminations.size() + 1;
     }
-
-    qDebug() << "Randomized teams to eliminate:";
-    for (const auto &team : teamsToEliminate)
+    else
     {
-        qDebug() << "  -" << team.first << "(" << team.second << "%)";
+        event["team"] = team.first;
+        event["odds"] = TeamTableModel::formatOdds(team.second);
+        event["pick"] = pick;
     }
+    broadcastServer->publish(event);
+}
 
-    QTimer::singleShot(500, this, [this, teamsToEliminate, winnerTeamName, winnerTeamOdds]() mutable
-                       {
-        qDebug() << "Timer fired, starting elimination for real";
-        int totalTeams = teamsToEliminate.size();
-        eliminateNextTeam(teamsToEliminate, 0, totalTeams, winnerTeamName, winnerTeamOdds); });
-}
-
-// Shows the elimination animation for a single team
-void MainWindow::showTeamElimination(const QString &teamName, int position, int odds, std::function<void()> onComplete)
-{
-    qDebug() << "showTeamElimination - Team:" << teamName << "Position:" << position;
-
-    QLabel *elimLabel = new QLabel(this);
-    elimLabel->setAttribute(Qt::WA_DeleteOnClose);
-
-    // Red text for eliminated teams
-    QString styleColor = "#ff0000";
-    int fontSize = 16;
-
-    // Format: "Eliminated: [Team Name] - [Odds]% chance of winning"
-    elimLabel->setText(QString("<h2 style='color:%1; font-size:%2pt; text-shadow: 2px 2px 5px black;'>ELIMINATED: %3 - %4% chance of winning</h2>")
-                           .arg(styleColor)
-                           .arg(fontSize)
-                           .arg(teamName)
-                           .arg(odds));
-
-    // Label styling improve later
-    elimLabel->setAlignment(Qt::AlignCenter);
-    elimLabel->setStyleSheet("background-color: rgba(30, 30, 30, 240); border: 2px solid #555; border-radius: 10px; padding: 15px; color: white;");
-    elimLabel->setFixedSize(750, 100);
-
-    // Position the label off-screen to the left
-    elimLabel->move(-elimLabel->width(), (height() - elimLabel->height()) / 2);
-    elimLabel->show();
-    elimLabel->raise();
-    qApp->processEvents();
-
-    // Slide in animation
-    QPropertyAnimation *slideIn = new QPropertyAnimation(elimLabel, "pos");
-    slideIn->setDuration(800);
-    slideIn->setStartValue(QPoint(-elimLabel->width(), (height() - elimLabel->height()) / 2));
-    slideIn->setEndValue(QPoint((width() - elimLabel->width()) / 2, (height() - elimLabel->height()) / 2));
-    slideIn->setEasingCurve(QEasingCurve::OutCubic);
-
-    // Pause label in middle of screen for 3 seconds
-    QSequentialAnimationGroup *animGroup = new QSequentialAnimationGroup(this);
-    animGroup->addAnimation(slideIn);
-    animGroup->addPause(3000);
-
-    // Slide out animation, move up slightly
-    QPropertyAnimation *slideOut = new QPropertyAnimation(elimLabel, "pos");
-    slideOut->setDuration(800);
-    slideOut->setStartValue(QPoint((width() - elimLabel->width()) / 2, (height() - elimLabel->height()) / 2));
-    slideOut->setEndValue(QPoint(width(), (height() - elimLabel->width()) / 2));
-    slideOut->setEasingCurve(QEasingCurve::InCubic);
-
-    animGroup->addAnimation(slideOut);
-
-    connect(animGroup, &QSequentialAnimationGroup::finished, this, [elimLabel, onComplete]()
-            {
-        elimLabel->deleteLater();
-        onComplete(); });
+// Collects the names and odds of every team with positive odds
+QVector<QPair<QString, int>> MainWindow::collectTeams() const
+{
+    return teamModel->drawableTeams();
+}
 
-    // Start the animation
-    animGroup->start(QAbstractAnimation::DeleteWhenStopped);
+void MainWindow::setHistoryPath(const QString &path)
+{
+    history->close();
+    historyPath = path;
 }
 
-// Starts the lottery process
-void MainWindow::on_btnDoLottery_clicked()
+bool MainWindow::openHistory()
 {
-    qDebug() << "Starting lottery process";
+    if (history->isOpen())
+        return true;
+    if (historyPath.isEmpty())
+        return false;
 
-    QVector<QString> teamNames;
-    QVector<int> teamOdds;
+    QDir().mkpath(QFileInfo(historyPath).absolutePath());
+    return history->open(QFile::encodeName(historyPath).toStdString());
+}
 
-    // Collect team names and odds from the input fields
-    for (int i = 0; i < oddsInputs.size(); ++i)
-    {
-        QLineEdit *oddsEdit = oddsInputs[i];
-        bool ok;
-        int odds = oddsEdit->text().toInt(&ok);
+// Appends the lottery just drawn, with the seed and draw number that replay it
+void MainWindow::recordLottery(const QVector<QPair<QString, int>> &teams, const std::vector<int> &order)
+{
+    if (historyPath.isEmpty())
+        return;
 
-        if (ok && odds > 0)
-        {
-            QLineEdit *nameEdit = qobject_cast<QLineEdit *>(oddsEdit->parentWidget()->layout()->itemAt(0)->widget());
-            QString teamName = nameEdit->text().trimmed();
+    HistoryStore::Run run;
+    run.timestamp = QDateTime::currentMSecsSinceEpoch();
+    run.seed = lotterySeed;
+    run.draw = drawIndex;
+    run.weightedOrder = weightedOrderAction->isChecked();
+    for (const auto &team : teams)
+    {
+        run.names.push_back(team.first.toStdString());
+        run.odds.push_back(team.second);
+    }
+    run.order = order;
 
-            // If team name is empty, provide a default name
-            if (teamName.isEmpty())
-            {
-                teamName = QString("Team %1").arg(i + 1);
-            }
+    if (!openHistory() || !history->append(run))
+        statusBar()->showMessage(QString("Seed %1, draw %2, not recorded: %3").arg(lotterySeed).arg(drawIndex).arg(QString::fromStdString(history->errorString())));
+}
 
-            teamNames.append(teamName);
-            teamOdds.append(odds);
-        }
+// Sums up every recorded lottery straight from the mapped log
+void MainWindow::showHistory()
+{
+    if (!openHistory())
+    {
+        QMessageBox::warning(this, "Lottery History", historyPath.isEmpty() ? QString("No lotteries are being recorded.")
+                                                                            : QString::fromStdString(history->errorString()));
+        return;
     }
 
-    int totalOdds = 0;
-    for (int odds : teamOdds)
+    QElapsedTimer timer;
+    timer.start();
+    HistoryStore::BestOdds favourite = history->bestOddsWins();
+    std::size_t tables = history->pickDistributions().size();
+    double milliseconds = timer.nsecsElapsed() / 1e6;
+
+    QString text = QString("%1 lotteries recorded in %2.").arg(history->runCount()).arg(QDir::toNativeSeparators(historyPath));
+    if (favourite.runs > 0)
     {
-        totalOdds += odds;
+        text += QString("\n\nThe team with the best odds won %1 of them (%2%), %3% was expected.")
+                    .arg(favourite.wins)
+                    .arg(100.0 * favourite.wins / favourite.runs, 0, 'f', 1)
+                    .arg(100.0 * favourite.expectedWins / favourite.runs, 0, 'f', 1);
+        text += QString("\n%1 different odds tables were used.").arg(tables);
     }
+    text += QString("\n\nRead in %1 ms.").arg(milliseconds, 0, 'f', 1);
+    QMessageBox::information(this, "Lottery History", text);
+}
 
-    int randomValue = QRandomGenerator::global()->bounded(totalOdds);
-    int cumulativeOdds = 0;
-    int winnerIndex = -1;
+// Simulates the full lottery many times on a background thread and shows the odds of every draft slot
+void MainWindow::simulatePickOdds()
+{
+    QVector<QPair<QString, int>> teams = collectTeams();
+    if (teams.size() < 2)
+    {
+        QMessageBox::information(this, "Simulate Pick Odds", "Enter odds for at least two teams first.");
+        return;
+    }
+    if (teams.size() > PickOddsSimulator::maxTeams)
+    {
+        QMessageBox::information(this, "Simulate Pick Odds",
+                                 QString("The simulation covers at most %1 teams, this table has %2.").arg(PickOddsSimulator::maxTeams).arg(teams.size()));
+        return;
+    }
 
-    // Whoever occupies the range of the random value is the winner
-    for (int i = 0; i < teamOdds.size(); ++i)
+    QStringList teamNames;
+    std::vector<std::int64_t> weights;
+    for (const auto &team : teams)
     {
-        cumulativeOdds += teamOdds[i];
-        if (randomValue < cumulativeOdds)
-        {
-            winnerIndex = i;
-            break;
-        }
+        teamNames.append(team.first);
+        weights.push_back(team.second);
     }
 
-    if (winnerIndex < 0)
-        return;
+    simulateAction->setEnabled(false);
+
+    QLabel *simulating = new QLabel("Simulating lotteries...", this);
+    simulating->setStyleSheet("background-color: rgba(30, 30, 30, 220); color: white; padding: 10px; border-radius: 5px;");
+    simulating->setAlignment(Qt::AlignCenter);
+    simulating->adjustSize();
+    simulating->move((width() - simulating->width()) / 2, 50);
+    simulating->raise();
+    simulating->show();
+
+    // The simulator spreads itself over every core, this thread only keeps the GUI responsive
+    auto result = std::make_shared<PickOddsResult>();
+    quint64 seed = QRandomGenerator::global()->generate64();
+    PickOddsSimulator::OrderMode mode = weightedOrderAction->isChecked() ? PickOddsSimulator::OrderMode::WeightedOrder
+                                                                         : PickOddsSimulator::OrderMode::WinnerThenShuffle;
+    QThread *worker = QThread::create([weights, mode, seed, result]()
+                                      {
+        PickOddsSimulator simulator(weights, mode);
+        *result = simulator.run(simulationTrials, 0, seed); });
+
+    connect(worker, &QThread::finished, this, [this, worker, simulating, teamNames, result]()
+            {
+        worker->deleteLater();
+        simulating->deleteLater();
+        simulateAction->setEnabled(true);
+
+        PickOddsDialog dialog(teamNames, *result, this);
+        dialog.exec(); });
+
+    worker->start();
+}
+
+// Starts the lottery process
+void MainWindow::on_btnDoLottery_clicked()
+{
+    startLottery();
+}
+
+bool MainWindow::startLottery()
+{
+    TRACE_SCOPE(Tracer::Reveal, "startLottery");
+
+    if (teamModel->totalOdds() != TeamTableModel::fullOdds || revealTimeline->isRunning())
+        return false;
 
-    QVector<QPair<QString, int>> teams;
-    for (int i = 0; i < teamNames.size(); ++i)
+    QVector<QPair<QString, int>> teams = collectTeams();
+
+    // The engine owns the weighted draw so the same logic can run without the window
+    std::vector<std::int64_t> weights;
+    for (const auto &team : teams)
     {
-        teams.append(qMakePair(teamNames[i], teamOdds[i]));
+        weights.push_back(team.second);
     }
 
-    QString winnerTeamName = teamNames[winnerIndex];
-    int winnerTeamOdds = teamOdds[winnerIndex];
+    // Stream `drawIndex` of the session seed, so the seed and the draw number replay this lottery exactly
+    Philox4x32 rng(lotterySeed, drawIndex);
+    std::vector<int> order = drawDraftOrder(weights, weightedOrderAction->isChecked(), rng);
+    if (order.empty())
+        return false;
+
+    QVector<int> draftOrder(order.begin(), order.end());
+    int winnerIndex = draftOrder.first();
+    confettiSeed = rng();
 
-    qDebug() << "Winner determined:" << winnerTeamName << "with odds:" << winnerTeamOdds;
-    qDebug() << "Total teams count:" << teams.size();
+    statusBar()->showMessage(QString("Seed %1, draw %2").arg(lotterySeed).arg(drawIndex));
+    recordLottery(teams, order);
+    ++drawIndex;
+
+    TRACE_INSTANT(Tracer::Reveal, "winner", winnerIndex);
 
     // Make sure the lottery can't be run again during animation
     ui->btnDoLottery->setEnabled(false);
 
-    QLabel *calculating = new QLabel("Drawing lottery...", this);
-    calculating->setStyleSheet("background-color: rgba(30, 30, 30, 220); color: white; padding: 10px; border-radius: 5px;");
-    calculating->setAlignment(Qt::AlignCenter);
-    calculating->adjustSize();
-    calculating->move((width() - calculating->width()) / 2, 50);
-    calculating->raise();
-    calculating->show();
-    qApp->processEvents();
-
-    // Start elimination
-    QTimer::singleShot(1000, [=]()
-                       {
-                           calculating->hide();
-                           calculating->deleteLater();
-                           qDebug() << "Starting elimination sequence";
-                           startEliminationSequence(teams, winnerIndex); });
-
-    // Calculate animation duration for final message box timing
-    int teamsToEliminate = teams.size() - 1;
-    int animationDuration = teamsToEliminate * 5400 + 4000;
+    startReveal(teams, draftOrder);
+    return true;
+}
 
-    qDebug() << "Teams to eliminate:" << teamsToEliminate;
-    qDebug() << "Total animation duration:" << animationDuration;
+void MainWindow::setKioskMode(bool enabled)
+{
+    kioskMode = enabled;
+}
 
-    // Show final message only after all animations
-    QTimer::singleShot(animationDuration, [this, winnerTeamName, winnerTeamOdds]()
-                       {
-        qDebug() << "Showing final winner message box";
-        QMessageBox winnerBox(this);
-        winnerBox.setWindowTitle("WE HAVE A WINNER!");
+void MainWindow::setRevealSpeed(double multiplier)
+{
+    revealTimeline->setSpeed(multiplier);
+}
 
-        QString winnerMessage = "<h2>Congratulations to:</h2>";
-        winnerMessage += QString("<h1 style='color:gold; font-size: 24pt;'>%1!</h1>")
-                             .arg(winnerTeamName);
-        winnerMessage += QString("<p>who will draft first overall. They had a <b>%1% chance</b> of winning.</p>")
-                             .arg(winnerTeamOdds);
+// The NBA's lottery odds for its 14 non-playoff teams, straight from the nba format's table
+void MainWindow::loadDemoTeams()
+{
+    using Nba = LotteryFormats::Nba2019;
+    static_assert(TeamTableModel::fullOdds % Nba::odds.assigned() == 0, "every combination must be a whole number of basis points");
+    const int perCombination = static_cast<int>(TeamTableModel::fullOdds / Nba::odds.assigned());
 
-        winnerBox.setText(winnerMessage);
-        winnerBox.exec();
+    QVector<TeamTableModel::Team> teams;
+    for (std::size_t i = 0; i < Nba::odds.combinations.size(); ++i)
+    {
+        TeamTableModel::Team team;
+        team.name = QString("Team %1").arg(i + 1);
+        team.odds = static_cast<int>(Nba::odds.combinations[i]) * perCombination;
+        teams.append(team);
+    }
 
-        // Re-enable lottery button
-        ui->btnDoLottery->setEnabled(true); });
+    teamModel->clear();
+    teamModel->appendTeams(teams);
+    finishImport(teams.size(), 0);
 }
@@ -1,9 +1,26 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include "revealtimeline.h"
+#include "teamtablemodel.h"
+
 #include <QMainWindow>
 #include <QLabel>
-#include <QLineEdit>
+#include <QAction>
+#include <QImage>
+
+#include <vector>
+
+class BroadcastServer;
+class CardRenderer;
+class ConfettiOverlay;
+class ConfettiSystem;
+class FrameTimingHud;
+class HistoryStore;
+class OddsExplorer;
+class QTimer;
+class RevealCard;
+class TeamImporter;
 
 QT_BEGIN_NAMESPACE
 namespace Ui
@@ -20,9 +37,35 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Same as pressing Do Lottery, false when the odds don't add up or a reveal is running
+    bool startLottery();
+
+    // Unattended displays: the winner goes to the status bar instead of a message box
+    void setKioskMode(bool enabled);
+    void setRevealSpeed(double multiplier);
+
+    // Replaces the teams with a 14 team league using the NBA's odds
+    void loadDemoTeams();
+
+    // Log every lottery is recorded in, an empty path records nothing
+    void setHistoryPath(const QString &path);
+
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+
+signals:
+    // Emitted once a reveal has been dismissed, or right after it ends in kiosk mode
+    void lotteryFinished();
+
 private slots:
     void on_dsbTeamCount_valueChanged(double arg1);
     void on_btnDoLottery_clicked();
+    void simulatePickOdds();
+    void appendImported(const QVector<TeamTableModel::Team> &teams);
+    void finishImport(int imported, int skipped);
+    void revealStepStarted(const RevealTimeline::Step &step);
+    void revealFrame(const RevealTimeline::Step &step, qreal progress);
+    void finishReveal();
 
 private:
     Ui::MainWindow *ui;
@@ -30,12 +73,67 @@ private:
 private:
     void updateTeamInputs(int count);
     void updateTotalOdds();
-    void showWinnerAnimation(const QString &winnerName, int winnerOdds);
-    void startEliminationSequence(const QVector<QPair<QString, int>> &teams, int winnerIndex);
-    void showTeamElimination(const QString &teamName, int position, int odds, std::function<void()> onComplete);
-    void eliminateNextTeam(const QVector<QPair<QString, int>> &teams, int currentIndex, int totalTeams, const QString &winnerName, int winnerOdds);
-    bool eventFilter(QObject *watched, QEvent *event) override;
-    QList<QLineEdit *> oddsInputs;
+    void updatePickOdds();
+    void refreshExactOdds();
+    void setOddsExplorerVisible(bool visible);
+    void startImport(const QString &path, const QString &text);
+    QVector<QPair<QString, int>> collectTeams() const;
+    void startReveal(const QVector<QPair<QString, int>> &teams, const QVector<int> &draftOrder);
+    void prepareEliminationCard(int elimination);
+    qreal revealScale() const;
+    QSizeF revealScene() const;
+    void advanceConfetti();
+    void setBroadcasting(bool enabled);
+    void broadcast(const QString &type, const QPair<QString, int> &team, int pick = 0);
+    bool openHistory();
+    void recordLottery(const QVector<QPair<QString, int>> &teams, const std::vector<int> &order);
+    void showHistory();
     QLabel *totalOddsLabel;
+    bool totalOddsComplete;
+    QAction *simulateAction;
+    QAction *weightedOrderAction;
+    QAction *oddsExplorerAction;
+    OddsExplorer *oddsExplorer;
+    QTimer *exactOddsTimer;
+    ConfettiSystem *confetti;
+    ConfettiOverlay *confettiOverlay;
+    FrameTimingHud *frameHud;
+    TeamTableModel *teamModel;
+    TeamImporter *teamImporter;
+
+    // The team list is only replaced once an import has produced its first team
+    bool importReplacing;
+
+    // Every lottery draws from stream drawIndex of lotterySeed
+    quint64 lotterySeed;
+    quint64 drawIndex;
+    quint64 confettiSeed;
+
+    // Reveal state, the timeline decides what is on screen
+    RevealTimeline *revealTimeline;
+    QAction *skipRevealAction;
+    QVector<QPair<QString, int>> revealEliminations;
+    QPair<QString, int> revealWinner;
+    RevealCard *drawingCard;
+    RevealCard *revealBackdrop;
+    CardRenderer *cardRenderer;
+    RevealCard *eliminationCard;
+    RevealCard *winnerCard;
+    QImage preparedCard;
+    int preparedCardIndex;
+    int shownCardIndex;
+    qint64 confettiStart;
+    qint64 confettiSteps;
+
+    // Spectator server, runs on its own thread while broadcasting is on
+    BroadcastServer *broadcastServer;
+    QAction *broadcastAction;
+    QLabel *viewerCountLabel;
+
+    bool kioskMode;
+
+    // Every lottery is appended to the history log, which is opened by the first one
+    HistoryStore *history;
+    QString historyPath;
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,363 @@
+#include "oddsexplorer.h"
+
+#include <QCloseEvent>
+#include <QHBoxLayout>
+#include <QHelpEvent>
+#include <QLabel>
+#include <QLocale>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QPushButton>
+#include <QThread>
+#include <QToolTip>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+    // Each stage runs eight times the lotteries of the one before: 16K, 131K, 1M, 8M
+    const int stageCount = 4;
+    const quint64 firstStageTrials = 16384;
+
+    // Every stage draws from its own block of streams, so later stages add independent lotteries
+    const int maxWorkers = 64;
+
+    QColor mix(const QColor &from, const QColor &to, qreal t)
+    {
+        return QColor::fromRgbF(from.redF() + (to.redF() - from.redF()) * t, from.greenF() + (to.greenF() - from.greenF()) * t,
+                                from.blueF() + (to.blueF() - from.blueF()) * t);
+    }
+}
+
+// One set of inputs being simulated, shared by its workers and dropped when superseded
+struct OddsExplorerJob
+{
+    OddsExplorerJob(const std::vector<std::int64_t> &weights, PickOddsSimulator::OrderMode mode)
+        : simulator(weights, mode)
+    {
+    }
+
+    PickOddsSimulator simulator;
+    quint64 generation = 0;
+    quint64 seed = 0;
+    std::atomic<bool> cancelled{false};
+    QElapsedTimer clock;
+
+    // Everything simulated so far, merged by each worker as it finishes
+    QMutex mutex;
+    std::vector<std::uint64_t> counts;
+    std::uint64_t trials = 0;
+    QAtomicInt pending;
+};
+
+// Rows are teams, columns are picks, darker cells are likelier.
+// Comparing shows the change from a pinned result instead, green for better chances and red for worse.
+class OddsHeatmap : public QWidget
+{
+public:
+    explicit OddsHeatmap(QWidget *parent)
+        : QWidget(parent), comparing(false)
+    {
+        setMinimumSize(320, 240);
+    }
+
+    void setResult(const QStringList &teamNames, const PickOddsResult &newResult)
+    {
+        names = teamNames;
+        result = newResult;
+        update();
+    }
+
+    void clear()
+    {
+        names.clear();
+        result = PickOddsResult();
+        update();
+    }
+
+    void setComparing(bool enabled)
+    {
+        comparing = enabled;
+        baseline = enabled ? result : PickOddsResult();
+        update();
+    }
+
+protected:
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter painter(this);
+        painter.fillRect(rect(), palette().base());
+
+        const int n = result.teamCount;
+        if (n == 0 || result.trials == 0)
+            return;
+
+        const bool showChange = comparing && baseline.teamCount == n && baseline.trials > 0;
+        const QFontMetrics metrics = fontMetrics();
+        const QColor empty = palette().base().color();
+        const QColor likely(30, 90, 200);
+        const QColor better(40, 160, 70);
+        const QColor worse(210, 60, 50);
+
+        for (int pick = 0; pick < n; ++pick)
+        {
+            QRect header = cellRect(0, pick);
+            header.moveTop(0);
+            header.setHeight(headerHeight);
+            if (header.width() >= metrics.horizontalAdvance(QString::number(n)) + 4)
+                painter.drawText(header, Qt::AlignCenter, QString::number(pick + 1));
+        }
+
+        for (int team = 0; team < n; ++team)
+        {
+            QRect row = cellRect(team, 0);
+            if (row.height() >= metrics.height() - 2)
+            {
+                QRect label(4, row.top(), labelWidth() - 8, row.height());
+                painter.setPen(palette().text().color());
+                painter.drawText(label, Qt::AlignVCenter | Qt::AlignLeft, metrics.elidedText(names.value(team), Qt::ElideRight, label.width()));
+            }
+
+            for (int pick = 0; pick < n; ++pick)
+            {
+                QRect cell = cellRect(team, pick);
+                double p = result.probability(team, pick);
+
+                QColor color;
+                QString text;
+                qreal strength;
+                if (showChange)
+                {
+                    double change = p - baseline.probability(team, pick);
+                    strength = std::min(1.0, std::abs(change) / 0.05);
+                    color = mix(empty, change >= 0 ? better : worse, strength);
+                    text = QString("%1%2").arg(change >= 0 ? "+" : "").arg(change * 100.0, 0, 'f', 1);
+                }
+                else
+                {
+                    // Square root so the long tail of small chances stays visible
+                    strength = std::sqrt(p);
+                    color = mix(empty, likely, strength);
+                    text = QString::number(p * 100.0, 'f', 1);
+                }
+                painter.fillRect(cell.adjusted(0, 0, -1, -1), color);
+
+                if (cell.width() >= metrics.horizontalAdvance(text) + 4 && cell.height() >= metrics.height())
+                {
+                    painter.setPen(strength > 0.6 ? Qt::white : palette().text().color());
+                    painter.drawText(cell, Qt::AlignCenter, text);
+                }
+            }
+        }
+    }
+
+    bool event(QEvent *event) override
+    {
+        if (event->type() != QEvent::ToolTip)
+            return QWidget::event(event);
+
+        QHelpEvent *help = static_cast<QHelpEvent *>(event);
+        const int n = result.teamCount;
+        if (n == 0 || help->pos().x() < labelWidth() || help->pos().y() < headerHeight)
+        {
+            QToolTip::hideText();
+            return true;
+        }
+
+        int pick = std::min(n - 1, (help->pos().x() - labelWidth()) * n / std::max(1, width() - labelWidth()));
+        int team = std::min(n - 1, (help->pos().y() - headerHeight) * n / std::max(1, height() - headerHeight));
+        QString tip = QString("%1, pick %2: %3%").arg(names.value(team)).arg(pick + 1).arg(result.probability(team, pick) * 100.0, 0, 'f', 2);
+        if (comparing && baseline.teamCount == n)
+            tip += QString(" (was %1%)").arg(baseline.probability(team, pick) * 100.0, 0, 'f', 2);
+        QToolTip::showText(help->globalPos(), tip, this);
+        return true;
+    }
+
+private:
+    static const int headerHeight = 20;
+
+    int labelWidth() const { return std::min(160, width() / 4); }
+
+    QRect cellRect(int team, int pick) const
+    {
+        const int n = result.teamCount;
+        int left = labelWidth() + (width() - labelWidth()) * pick / n;
+        int right = labelWidth() + (width() - labelWidth()) * (pick + 1) / n;
+        int top = headerHeight + (height() - headerHeight) * team / n;
+        int bottom = headerHeight + (height() - headerHeight) * (team + 1) / n;
+        return QRect(left, top, right - left, bottom - top);
+    }
+
+    QStringList names;
+    PickOddsResult result;
+    PickOddsResult baseline;
+    bool comparing;
+};
+
+OddsExplorer::OddsExplorer(QWidget *parent)
+    : QWidget(parent, Qt::Window), weightedOrder(false), dirty(false), seed(0x5eed), generation(0)
+{
+    setWindowTitle("What-If Odds");
+    resize(760, 600);
+
+    heatmap = new OddsHeatmap(this);
+    statusLabel = new QLabel(this);
+    compareButton = new QPushButton("Compare to Current", this);
+    compareButton->setCheckable(true);
+    compareButton->setToolTip("Pin the odds shown now and show how later changes move every team's chances");
+    connect(compareButton, &QPushButton::toggled, this, [this](bool checked)
+            { heatmap->setComparing(checked); });
+
+    QHBoxLayout *footer = new QHBoxLayout();
+    footer->addWidget(statusLabel, 1);
+    footer->addWidget(compareButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(heatmap, 1);
+    layout->addLayout(footer);
+
+    // One core is left for the GUI thread
+    pool.setMaxThreadCount(std::min(maxWorkers, std::max(1, QThread::idealThreadCount() - 1)));
+}
+
+OddsExplorer::~OddsExplorer()
+{
+    cancel();
+    pool.waitForDone();
+}
+
+void OddsExplorer::setTeams(const QStringList &teamNames, const std::vector<std::int64_t> &teamWeights, bool weighted)
+{
+    names = teamNames;
+    weights = teamWeights;
+    weightedOrder = weighted;
+    restart();
+}
+
+void OddsExplorer::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    if (dirty)
+        restart();
+}
+
+void OddsExplorer::closeEvent(QCloseEvent *event)
+{
+    cancel();
+    emit closed();
+    QWidget::closeEvent(event);
+}
+
+// Supersedes whatever is running with the current inputs
+void OddsExplorer::restart()
+{
+    cancel();
+    ++generation;
+
+    if (!isVisible())
+    {
+        dirty = true;
+        return;
+    }
+    dirty = false;
+
+    if (names.size() > PickOddsSimulator::maxTeams)
+    {
+        heatmap->clear();
+        statusLabel->setText(QString("The explorer shows at most %1 teams, this table has %2.").arg(PickOddsSimulator::maxTeams).arg(names.size()));
+        return;
+    }
+
+    auto job = std::make_shared<OddsExplorerJob>(weights, weightedOrder ? PickOddsSimulator::OrderMode::WeightedOrder
+                                                                        : PickOddsSimulator::OrderMode::WinnerThenShuffle);
+    if (names.size() < 2 || !job->simulator.isValid())
+    {
+        heatmap->clear();
+        statusLabel->setText("Enter odds for at least two teams.");
+        return;
+    }
+
+    job->generation = generation;
+    job->seed = seed;
+    job->counts.assign(static_cast<std::size_t>(names.size()) * names.size(), 0);
+    job->clock.start();
+    current = job;
+    sinceChange.start();
+
+    startStage(job, 0);
+}
+
+// Workers stop at their next check, their results are never published
+void OddsExplorer::cancel()
+{
+    if (current)
+        current->cancelled.store(true, std::memory_order_relaxed);
+    current.reset();
+}
+
+// Runs on the GUI thread for the first stage and on the last worker of a stage for the rest
+void OddsExplorer::startStage(const std::shared_ptr<OddsExplorerJob> &job, int stage)
+{
+    const int workers = pool.maxThreadCount();
+    const quint64 trials = firstStageTrials << (3 * stage);
+    job->pending.storeRelease(workers);
+
+    for (int t = 0; t < workers; ++t)
+    {
+        quint64 share = trials / workers + (static_cast<quint64>(t) < trials % workers ? 1 : 0);
+        pool.start([this, job, stage, t, share]()
+                   {
+            const int n = job->simulator.teamCount();
+            std::vector<std::uint64_t> counts(static_cast<std::size_t>(n) * n, 0);
+            std::uint64_t done = job->simulator.runStream(share, job->seed, static_cast<unsigned>(stage * maxWorkers + t), counts.data(), &job->cancelled);
+
+            {
+                QMutexLocker locker(&job->mutex);
+                for (std::size_t i = 0; i < counts.size(); ++i)
+                    job->counts[i] += counts[i];
+                job->trials += done;
+            }
+
+            // The last worker of the stage publishes it and starts the next one
+            if (job->pending.fetchAndSubAcquire(1) != 1 || job->cancelled.load(std::memory_order_relaxed))
+                return;
+
+            PickOddsResult result;
+            {
+                QMutexLocker locker(&job->mutex);
+                result.counts = job->counts;
+                result.trials = job->trials;
+            }
+            result.teamCount = n;
+            result.threads = pool.maxThreadCount();
+            result.seconds = job->clock.nsecsElapsed() / 1e9;
+
+            quint64 jobGeneration = job->generation;
+            QMetaObject::invokeMethod(this, [this, jobGeneration, result, stage]()
+                                      { publish(jobGeneration, result, stage); }, Qt::QueuedConnection);
+
+            if (stage + 1 < stageCount)
+                startStage(job, stage + 1); });
+    }
+}
+
+void OddsExplorer::publish(quint64 jobGeneration, const PickOddsResult &result, int stage)
+{
+    // The inputs changed since this job started
+    if (jobGeneration != generation)
+        return;
+
+    heatmap->setResult(names, result);
+
+    QString lotteries = QLocale().toString(static_cast<qulonglong>(result.trials));
+    if (stage == 0)
+        statusLabel->setText(QString("%1 lotteries, shown %2 ms after the change, refining...").arg(lotteries).arg(sinceChange.elapsed()));
+    else if (stage + 1 < stageCount)
+        statusLabel->setText(QString("%1 lotteries, refining...").arg(lotteries));
+    else
+        statusLabel->setText(QString("%1 lotteries in %2 s").arg(lotteries).arg(result.seconds, 0, 'f', 2));
+}
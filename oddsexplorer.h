@@ -0,0 +1,66 @@
+#ifndef ODDSEXPLORER_H
+#define ODDSEXPLORER_H
+
+#include "pickoddssimulator.h"
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QThreadPool>
+#include <QWidget>
+
+#include <memory>
+#include <vector>
+
+class OddsHeatmap;
+class QLabel;
+class QPushButton;
+struct OddsExplorerJob;
+
+// Live team x pick heatmap for trying out odds before a lottery.
+// Every change of the odds starts a new simulation on a worker pool and
+// cancels the one before it, workers notice within a few thousand lotteries.
+// Results come in stages, a coarse estimate within a few milliseconds and
+// then ever larger runs refining it, and a stage that finishes after its
+// inputs changed is dropped. The GUI thread only swaps in finished results.
+class OddsExplorer : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit OddsExplorer(QWidget *parent = nullptr);
+    ~OddsExplorer();
+
+    // Recomputes for these teams, only while the explorer is shown
+    void setTeams(const QStringList &names, const std::vector<std::int64_t> &weights, bool weightedOrder);
+
+signals:
+    void closed();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void closeEvent(QCloseEvent *event) override;
+
+private:
+    void restart();
+    void cancel();
+    void startStage(const std::shared_ptr<OddsExplorerJob> &job, int stage);
+    void publish(quint64 generation, const PickOddsResult &result, int stage);
+
+    OddsHeatmap *heatmap;
+    QLabel *statusLabel;
+    QPushButton *compareButton;
+    QThreadPool pool;
+
+    QStringList names;
+    std::vector<std::int64_t> weights;
+    bool weightedOrder;
+    bool dirty;
+
+    // Same seed for every job, so a small change of the odds shows as a small change of the map
+    quint64 seed;
+    quint64 generation;
+    std::shared_ptr<OddsExplorerJob> current;
+    QElapsedTimer sinceChange;
+};
+
+#endif // ODDSEXPLORER_H
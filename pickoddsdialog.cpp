@@ -0,0 +1,49 @@
+#include "pickoddsdialog.h"
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QLocale>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+PickOddsDialog::PickOddsDialog(const QStringList &teamNames, const PickOddsResult &result, QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Pick Position Odds");
+    resize(900, 500);
+
+    QTableWidget *table = new QTableWidget(result.teamCount, result.teamCount, this);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setVerticalHeaderLabels(teamNames);
+
+    QStringList pickLabels;
+    for (int slot = 0; slot < result.teamCount; ++slot)
+    {
+        pickLabels.append(QString("Pick %1").arg(slot + 1));
+    }
+    table->setHorizontalHeaderLabels(pickLabels);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    for (int team = 0; team < result.teamCount; ++team)
+    {
+        for (int slot = 0; slot < result.teamCount; ++slot)
+        {
+            QTableWidgetItem *item = new QTableWidgetItem(QString("%1%").arg(result.probability(team, slot) * 100.0, 0, 'f', 2));
+            item->setTextAlignment(Qt::AlignCenter);
+            table->setItem(team, slot, item);
+        }
+    }
+
+    // Throughput is reported per core so runs on different machines compare
+    QLabel *summary = new QLabel(QString("%1 lotteries on %2 threads in %3 s (%4 million draws/sec/core)")
+                                     .arg(QLocale().toString(static_cast<qulonglong>(result.trials)))
+                                     .arg(result.threads)
+                                     .arg(result.seconds, 0, 'f', 2)
+                                     .arg(result.drawsPerSecondPerCore() / 1e6, 0, 'f', 1),
+                                 this);
+    summary->setAlignment(Qt::AlignCenter);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(table);
+    layout->addWidget(summary);
+}
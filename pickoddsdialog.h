@@ -0,0 +1,18 @@
+#ifndef PICKODDSDIALOG_H
+#define PICKODDSDIALOG_H
+
+#include "pickoddssimulator.h"
+
+#include <QDialog>
+#include <QStringList>
+
+// Shows each team's chance of landing at every draft slot
+class PickOddsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    PickOddsDialog(const QStringList &teamNames, const PickOddsResult &result, QWidget *parent = nullptr);
+};
+
+#endif // PICKODDSDIALOG_H
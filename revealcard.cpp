@@ -0,0 +1,33 @@
+#include "revealcard.h"
+
+#include <QPainter>
+
+RevealCard::RevealCard(QWidget *parent)
+    : QWidget(parent), opacity(1.0)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAttribute(Qt::WA_NoSystemBackground);
+}
+
+void RevealCard::setImage(const QImage &image)
+{
+    pixmap = QPixmap::fromImage(image);
+    opacity = 1.0;
+    setFixedSize((QSizeF(pixmap.size()) / pixmap.devicePixelRatioF()).toSize());
+    update();
+}
+
+void RevealCard::setOpacity(qreal value)
+{
+    if (qFuzzyCompare(opacity, value))
+        return;
+    opacity = value;
+    update();
+}
+
+void RevealCard::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setOpacity(opacity);
+    painter.drawPixmap(0, 0, pixmap);
+}
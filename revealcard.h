@@ -0,0 +1,31 @@
+#ifndef REVEALCARD_H
+#define REVEALCARD_H
+
+#include <QPixmap>
+#include <QWidget>
+
+// A reveal card that only blits a pre-rendered pixmap.
+// The window keeps one per card type and swaps the image between teams, so
+// moving or fading a card never re-lays out text or re-polishes a style.
+class RevealCard : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit RevealCard(QWidget *parent = nullptr);
+
+    // Takes a card from CardRenderer and resizes to its logical size
+    void setImage(const QImage &image);
+
+    // Drawn with this opacity, cheaper than a graphics effect since nothing is re-rendered offscreen
+    void setOpacity(qreal opacity);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QPixmap pixmap;
+    qreal opacity;
+};
+
+#endif // REVEALCARD_H
@@ -0,0 +1,332 @@
+#include "revealexporter.h"
+#include "cardrenderer.h"
+#include "confettioverlay.h"
+#include "confettisystem.h"
+#include "revealtimeline.h"
+#include "tracer.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QPainter>
+#include <QThread>
+#include <QThreadPool>
+
+#include <cstdio>
+
+#ifdef Q_OS_WIN
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace
+{
+    // The window's height, so cards keep their on-screen proportions at any export size
+    const qreal sceneHeight = 768.0;
+
+    // Same distance from the top as the window's status label
+    const qreal labelTop = 50.0;
+
+    // One confetti physics step, as in the window
+    const qint64 confettiStep = 16;
+
+    const QColor backdropColor(18, 18, 18);
+
+    QSizeF logicalSize(const QImage &image)
+    {
+        return QSizeF(image.size()) / image.devicePixelRatio();
+    }
+}
+
+bool RevealExporter::FrameState::looksLike(const FrameState &other) const
+{
+    return !confetti && !other.confetti && drawing == other.drawing && elimination == other.elimination &&
+           eliminationPosition == other.eliminationPosition && winner == other.winner &&
+           winnerPosition == other.winnerPosition && qFuzzyCompare(winnerOpacity, other.winnerOpacity);
+}
+
+RevealExporter::RevealExporter(const QVector<QPair<QString, int>> &teams, const QVector<int> &draftOrder, quint64 confettiSeed)
+    : confettiSeed(confettiSeed), scale(1.0), written(0), painted(0)
+{
+    // The team drafting last is eliminated first
+    winningTeam = teams[draftOrder.first()];
+    for (int i = draftOrder.size() - 1; i > 0; --i)
+        eliminations.append(teams[draftOrder[i]]);
+}
+
+bool RevealExporter::exportTo(const QString &path, const Settings &settings, QString &error)
+{
+    if (settings.size.isEmpty() || settings.fps <= 0 || settings.fps > 1000)
+    {
+        error = "export size and frame rate must be positive";
+        return false;
+    }
+
+    // Frames go to a raw stream or one PNG per frame
+    bool raw = path == "-" || path.endsWith(".raw", Qt::CaseInsensitive);
+    QFile stream;
+    QDir directory(path);
+    if (path == "-")
+    {
+#ifdef Q_OS_WIN
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        stream.open(stdout, QIODevice::WriteOnly);
+    }
+    else if (raw)
+    {
+        stream.setFileName(path);
+        if (!stream.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            error = QString("%1: %2").arg(path, stream.errorString());
+            return false;
+        }
+    }
+    else if (!directory.mkpath("."))
+    {
+        error = QString("%1: cannot create the directory").arg(path);
+        return false;
+    }
+
+    scale = settings.size.height() / sceneHeight;
+    scene = QSizeF(settings.size.width() / scale, sceneHeight);
+
+    backdrop = QImage(settings.size, QImage::Format_RGB32);
+    backdrop.fill(backdropColor);
+    if (!settings.background.isNull())
+    {
+        QImage scaled = settings.background.scaled(settings.size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+        QPainter painter(&backdrop);
+        painter.drawImage(QPoint((settings.size.width() - scaled.width()) / 2, (settings.size.height() - scaled.height()) / 2), scaled);
+    }
+    backdrop.setDevicePixelRatio(scale);
+
+    // Every card is rendered once up front, the workers only composite them
+    CardRenderer renderer;
+    renderer.setDevicePixelRatio(scale);
+    drawingImage = renderer.labelCard("Drawing lottery...");
+    eliminationImages.clear();
+    for (const auto &team : eliminations)
+        eliminationImages.append(renderer.eliminationCard(team.first, team.second));
+    winnerImage = renderer.winnerCard(winningTeam.first, winningTeam.second);
+    confettiAtlas = ConfettiOverlay::spriteAtlas(scale);
+
+    // The window's reveal, replayed step by step into `state`
+    ConfettiSystem confetti(settings.confettiBurst);
+    FrameState state;
+    qint64 confettiStart = 0;
+    qint64 confettiSteps = 0;
+    bool finished = false;
+
+    RevealTimeline timeline;
+    timeline.setEliminations(eliminations.size());
+
+    QObject::connect(&timeline, &RevealTimeline::stepStarted, [&](const RevealTimeline::Step &step)
+                     {
+        switch (step.phase)
+        {
+        case RevealTimeline::Phase::Drawing:
+            state.drawing = true;
+            break;
+
+        case RevealTimeline::Phase::SlideIn:
+            state.drawing = false;
+            state.elimination = step.elimination;
+            break;
+
+        case RevealTimeline::Phase::Gap:
+            state.elimination = -1;
+            break;
+
+        case RevealTimeline::Phase::WinnerDrop:
+            state.drawing = false;
+            state.winner = true;
+            confetti.reset();
+            confetti.setSeed(confettiSeed);
+            confetti.setBounds(scene.width(), scene.height());
+            confetti.burst(scene.width() / 2, scene.height() / 3, settings.confettiBurst);
+            break;
+
+        case RevealTimeline::Phase::WinnerHold:
+            confetti.setEmitter(scene.width() / 2, scene.height() / 3, true);
+            state.confetti = true;
+            confettiStart = step.start;
+            confettiSteps = 0;
+            break;
+
+        default:
+            break;
+        } });
+
+    QObject::connect(&timeline, &RevealTimeline::frame, [&](const RevealTimeline::Step &step, qreal progress)
+                     {
+        switch (step.phase)
+        {
+        case RevealTimeline::Phase::SlideIn:
+        case RevealTimeline::Phase::Hold:
+        case RevealTimeline::Phase::SlideOut:
+            state.eliminationPosition = RevealTimeline::cardPosition(step, progress, scene, logicalSize(eliminationImages[step.elimination]));
+            break;
+
+        case RevealTimeline::Phase::WinnerDrop:
+        case RevealTimeline::Phase::WinnerHold:
+        case RevealTimeline::Phase::WinnerFade:
+            state.winnerPosition = RevealTimeline::cardPosition(step, progress, scene, logicalSize(winnerImage));
+            state.winnerOpacity = RevealTimeline::cardOpacity(step, progress);
+            break;
+
+        default:
+            break;
+        }
+
+        // Every physics step is run, unlike the window there is no frame budget to keep
+        if (state.confetti)
+        {
+            qint64 due = (timeline.elapsed() - confettiStart) / confettiStep;
+            for (; confettiSteps < due; ++confettiSteps)
+                confetti.update();
+        } });
+
+    QObject::connect(&timeline, &RevealTimeline::finished, [&finished]()
+                     { finished = true; });
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(settings.threads > 0 ? settings.threads : QThread::idealThreadCount());
+
+    // Enough frames in flight to keep every worker busy, few enough to bound memory at 4K
+    const int batchSize = pool.maxThreadCount() * 2;
+    QVector<FrameState> batch;
+    QVector<QByteArray> encoded(batchSize);
+    FrameState previousState;
+    QByteArray previousFrame;
+    written = 0;
+    painted = 0;
+
+    auto flush = [&]() -> bool
+    {
+        for (int i = 0; i < batch.size(); ++i)
+        {
+            const FrameState &before = i > 0 ? batch[i - 1] : previousState;
+            if ((i > 0 || written > 0) && batch[i].looksLike(before))
+            {
+                encoded[i].clear();
+                continue;
+            }
+
+            ++painted;
+            pool.start([this, &batch, &encoded, i, raw]()
+                       {
+                TRACE_SCOPE(Tracer::Frame, "exportFrame");
+                QImage frame = paintFrame(batch.at(i));
+                if (raw)
+                {
+                    encoded[i] = QByteArray(reinterpret_cast<const char *>(frame.constBits()), frame.sizeInBytes());
+                    return;
+                }
+
+                QBuffer buffer(&encoded[i]);
+                buffer.open(QIODevice::WriteOnly);
+                frame.save(&buffer, "PNG"); });
+        }
+        pool.waitForDone();
+
+        for (int i = 0; i < batch.size(); ++i)
+        {
+            // An empty entry repeats the frame before it
+            if (!encoded[i].isEmpty())
+                previousFrame = encoded[i];
+
+            if (raw)
+            {
+                if (stream.write(previousFrame) != previousFrame.size())
+                {
+                    error = QString("%1: %2").arg(path, stream.errorString());
+                    return false;
+                }
+            }
+            else
+            {
+                QFile file(directory.filePath(QString("frame_%1.png").arg(written, 5, 10, QChar('0'))));
+                if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(previousFrame) != previousFrame.size())
+                {
+                    error = QString("%1: %2").arg(file.fileName(), file.errorString());
+                    return false;
+                }
+            }
+            ++written;
+        }
+
+        previousState = batch.last();
+        batch.clear();
+        return true;
+    };
+
+    timeline.start(RevealTimeline::Clock::Virtual);
+    for (qint64 frame = 0; !finished; ++frame)
+    {
+        // Frame times are whole milliseconds from the frame number, so 60 fps alternates 16 and 17 ms
+        if (frame > 0)
+            timeline.advance(frame * 1000 / settings.fps - timeline.elapsed());
+        if (finished)
+            break;
+
+        batch.append(state);
+        if (state.confetti)
+        {
+            FrameState &snapshot = batch.last();
+            int count = confetti.size();
+            snapshot.x.assign(confetti.x(), confetti.x() + count);
+            snapshot.y.assign(confetti.y(), confetti.y() + count);
+            snapshot.rotation.assign(confetti.rotation(), confetti.rotation() + count);
+            snapshot.size.assign(confetti.particleSize(), confetti.particleSize() + count);
+            snapshot.color.assign(confetti.color(), confetti.color() + count);
+        }
+
+        if (batch.size() == batchSize && !flush())
+            return false;
+    }
+
+    if (!batch.isEmpty() && !flush())
+        return false;
+
+    stream.flush();
+    return true;
+}
+
+// Composites one frame, only reads state set up before the workers started
+QImage RevealExporter::paintFrame(const FrameState &state) const
+{
+    QImage frame = backdrop.copy();
+    frame.setDevicePixelRatio(scale);
+
+    QPainter painter(&frame);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    if (state.drawing)
+        painter.drawImage(QPointF((scene.width() - logicalSize(drawingImage).width()) / 2, labelTop), drawingImage);
+
+    if (state.elimination >= 0)
+        painter.drawImage(state.eliminationPosition, eliminationImages[state.elimination]);
+
+    if (state.winner)
+    {
+        painter.setOpacity(state.winnerOpacity);
+        painter.drawImage(state.winnerPosition, winnerImage);
+        painter.setOpacity(1.0);
+    }
+
+    // The confetti overlay sits above the winner card, as in the window
+    if (state.confetti)
+    {
+        const QRectF visible(QPointF(0, 0), scene);
+        for (std::size_t i = 0; i < state.x.size(); ++i)
+        {
+            QRectF target = ConfettiOverlay::spriteTarget(state.x[i], state.y[i], state.size[i]);
+            if (!visible.intersects(target))
+                continue;
+            painter.drawImage(target, confettiAtlas, ConfettiOverlay::spriteSource(state.rotation[i], state.color[i], scale));
+        }
+    }
+
+    return frame;
+}
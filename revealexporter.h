@@ -0,0 +1,85 @@
+#ifndef REVEALEXPORTER_H
+#define REVEALEXPORTER_H
+
+#include <QImage>
+#include <QPair>
+#include <QPointF>
+#include <QSize>
+#include <QSizeF>
+#include <QString>
+#include <QVector>
+
+#include <cstdint>
+#include <vector>
+
+// Renders a lottery reveal to an image sequence or a raw video stream without a window.
+// The reveal runs on RevealTimeline's virtual clock, one fixed step per frame,
+// so what a frame shows depends only on its number. The calling thread walks
+// the timeline and snapshots each frame's card positions and confetti, which
+// is cheap, and a thread pool paints and encodes the frames, which is not.
+// Frames are written in order and a frame that looks like the one before it
+// is painted once and written again.
+class RevealExporter
+{
+public:
+    struct Settings
+    {
+        QSize size = QSize(1920, 1080);
+        int fps = 60;
+        int threads = 0;     // 0 uses every core
+        QImage background;   // Scaled to fill the frame, a dark backdrop when null
+        int confettiBurst = 5000;
+    };
+
+    // `draftOrder` indexes `teams`, the first entry wins. `confettiSeed` is the
+    // seed the window used for the same draw.
+    RevealExporter(const QVector<QPair<QString, int>> &teams, const QVector<int> &draftOrder, quint64 confettiSeed);
+
+    // Writes frame_00000.png and onwards into the directory `path`, or raw BGRA
+    // frames to `path` when it ends in .raw ("-" is stdout). Returns false with a message on failure.
+    bool exportTo(const QString &path, const Settings &settings, QString &error);
+
+    int framesWritten() const { return written; }
+    int framesPainted() const { return painted; }
+
+private:
+    // Everything one frame shows, in scene coordinates
+    struct FrameState
+    {
+        bool drawing = false;
+        int elimination = -1;
+        QPointF eliminationPosition;
+        bool winner = false;
+        QPointF winnerPosition;
+        qreal winnerOpacity = 1.0;
+
+        bool confetti = false;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> rotation;
+        std::vector<float> size;
+        std::vector<std::uint8_t> color;
+
+        bool looksLike(const FrameState &other) const;
+    };
+
+    QImage paintFrame(const FrameState &state) const;
+
+    QVector<QPair<QString, int>> eliminations;
+    QPair<QString, int> winningTeam;
+    quint64 confettiSeed;
+
+    // Set up by exportTo for the painting workers, which only read them
+    qreal scale;
+    QSizeF scene;
+    QImage backdrop;
+    QImage drawingImage;
+    QVector<QImage> eliminationImages;
+    QImage winnerImage;
+    QImage confettiAtlas;
+
+    int written;
+    int painted;
+};
+
+#endif // REVEALEXPORTER_H
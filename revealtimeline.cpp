@@ -0,0 +1,171 @@
+#include "revealtimeline.h"
+
+#include <QEasingCurve>
+
+// Step lengths in milliseconds, one elimination card takes 5.4 s including the gap after it
+static const qint64 drawingDuration = 1500;
+static const qint64 slideInDuration = 800;
+static const qint64 holdDuration = 3000;
+static const qint64 slideOutDuration = 800;
+static const qint64 gapDuration = 800;
+static const qint64 winnerDropDuration = 1200;
+static const qint64 winnerHoldDuration = 3000;
+static const qint64 winnerFadeDuration = 800;
+
+// Target interval of the real-time frame clock
+static const int frameInterval = 16;
+
+RevealTimeline::RevealTimeline(QObject *parent)
+    : QObject(parent), current(0), time(0), running(false), speedMultiplier(1.0), carry(0.0), lastTick(0)
+{
+    timer.setTimerType(Qt::PreciseTimer);
+    timer.setInterval(frameInterval);
+    connect(&timer, &QTimer::timeout, this, &RevealTimeline::tick);
+}
+
+void RevealTimeline::setEliminations(int count)
+{
+    steps.clear();
+    qint64 at = 0;
+
+    auto add = [this, &at](Phase phase, int elimination, qint64 duration)
+    {
+        steps.append(Step{phase, elimination, at, duration});
+        at += duration;
+    };
+
+    add(Phase::Drawing, -1, drawingDuration);
+    for (int i = 0; i < count; ++i)
+    {
+        add(Phase::SlideIn, i, slideInDuration);
+        add(Phase::Hold, i, holdDuration);
+        add(Phase::SlideOut, i, slideOutDuration);
+        add(Phase::Gap, i, gapDuration);
+    }
+    add(Phase::WinnerDrop, -1, winnerDropDuration);
+    add(Phase::WinnerHold, -1, winnerHoldDuration);
+    add(Phase::WinnerFade, -1, winnerFadeDuration);
+}
+
+void RevealTimeline::start(Clock clockType)
+{
+    if (steps.isEmpty())
+        setEliminations(0);
+
+    current = 0;
+    time = 0;
+    carry = 0.0;
+    running = true;
+
+    emit stepStarted(steps[0]);
+    if (!running)
+        return;
+    emit frame(steps[0], 0.0);
+
+    if (running && clockType == Clock::RealTime)
+    {
+        clock.start();
+        lastTick = 0;
+        timer.start();
+    }
+}
+
+void RevealTimeline::skipToEnd()
+{
+    if (running)
+        finish();
+}
+
+void RevealTimeline::advance(qint64 milliseconds)
+{
+    if (!running)
+        return;
+
+    time += milliseconds;
+
+    // Finish every step the clock went past, so none of them is skipped over
+    while (time >= steps[current].start + steps[current].duration)
+    {
+        emit frame(steps[current], 1.0);
+        if (!running)
+            return;
+
+        if (++current >= steps.size())
+        {
+            finish();
+            return;
+        }
+
+        emit stepStarted(steps[current]);
+        if (!running)
+            return;
+    }
+
+    const Step &step = steps[current];
+    emit frame(step, static_cast<qreal>(time - step.start) / step.duration);
+}
+
+void RevealTimeline::setSpeed(double multiplier)
+{
+    speedMultiplier = multiplier > 0.0 ? multiplier : 1.0;
+}
+
+// Converts real time since the last tick into reveal time, keeping the fraction for the next tick
+void RevealTimeline::tick()
+{
+    qint64 now = clock.elapsed();
+    carry += (now - lastTick) * speedMultiplier;
+    lastTick = now;
+
+    qint64 whole = static_cast<qint64>(carry);
+    carry -= whole;
+    if (whole > 0)
+        advance(whole);
+}
+
+void RevealTimeline::finish()
+{
+    running = false;
+    timer.stop();
+    current = steps.size();
+    time = totalDuration();
+    emit finished();
+}
+
+QPointF RevealTimeline::cardPosition(const Step &step, qreal progress, const QSizeF &scene, const QSizeF &card)
+{
+    QPointF centered((scene.width() - card.width()) / 2, (scene.height() - card.height()) / 2);
+
+    switch (step.phase)
+    {
+    case Phase::SlideIn:
+    {
+        QPointF from(-card.width(), centered.y());
+        return from + (centered - from) * QEasingCurve(QEasingCurve::OutCubic).valueForProgress(progress);
+    }
+
+    case Phase::SlideOut:
+    {
+        // Slide out to the right, moving up slightly
+        QPointF to(scene.width(), (scene.height() - card.width()) / 2);
+        return centered + (to - centered) * QEasingCurve(QEasingCurve::InCubic).valueForProgress(progress);
+    }
+
+    case Phase::WinnerDrop:
+    {
+        // Drop the card into the center of the screen
+        QPointF from(centered.x(), -card.height());
+        return from + (centered - from) * QEasingCurve(QEasingCurve::OutBounce).valueForProgress(progress);
+    }
+
+    default:
+        return centered;
+    }
+}
+
+qreal RevealTimeline::cardOpacity(const Step &step, qreal progress)
+{
+    if (step.phase != Phase::WinnerFade)
+        return 1.0;
+    return 1.0 - QEasingCurve(QEasingCurve::InQuad).valueForProgress(progress);
+}
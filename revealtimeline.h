@@ -0,0 +1,108 @@
+#ifndef REVEALTIMELINE_H
+#define REVEALTIMELINE_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointF>
+#include <QSizeF>
+#include <QTimer>
+#include <QVector>
+
+// Schedule of the whole lottery reveal, from "Drawing lottery..." through
+// every elimination card to the winner's fade out.
+// All phase timings live in one list and a single frame clock walks it,
+// reporting which step is active and how far along it is. The window only
+// positions its widgets from those reports, so a speed multiplier or a skip
+// can never leave the pieces out of sync. With Clock::Virtual nothing runs on
+// its own and advance() moves time forward, so a full reveal can be stepped
+// through in microseconds.
+class RevealTimeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Phase
+    {
+        Drawing,
+        SlideIn,
+        Hold,
+        SlideOut,
+        Gap,
+        WinnerDrop,
+        WinnerHold,
+        WinnerFade
+    };
+
+    enum class Clock
+    {
+        RealTime,
+        Virtual
+    };
+
+    struct Step
+    {
+        Phase phase;
+        int elimination; // Index into the elimination order, -1 outside the elimination cards
+        qint64 start;
+        qint64 duration;
+    };
+
+    explicit RevealTimeline(QObject *parent = nullptr);
+
+    // Lays out the steps for a reveal that eliminates `count` teams before the winner
+    void setEliminations(int count);
+
+    void start(Clock clock = Clock::RealTime);
+
+    // Jumps straight to the end, finished() is emitted right away
+    void skipToEnd();
+
+    // Moves the timeline forward by `milliseconds` of reveal time
+    void advance(qint64 milliseconds);
+
+    // 2.0 plays the reveal twice as fast, only affects the real-time clock
+    void setSpeed(double multiplier);
+    double speed() const { return speedMultiplier; }
+
+    bool isRunning() const { return running; }
+    qint64 elapsed() const { return time; }
+    qint64 totalDuration() const { return steps.isEmpty() ? 0 : steps.last().start + steps.last().duration; }
+    const QVector<Step> &schedule() const { return steps; }
+
+    // The clock's timer, for frame timing
+    QTimer *frameTimer() { return &timer; }
+
+    // Top left corner of the card `step` moves, `progress` of the way through it,
+    // in a scene of size `scene`. The window and the frame exporter both place
+    // their cards with it, so they follow the same easing curves.
+    static QPointF cardPosition(const Step &step, qreal progress, const QSizeF &scene, const QSizeF &card);
+
+    // Opacity of the winner card, which fades out in the last step
+    static qreal cardOpacity(const Step &step, qreal progress);
+
+signals:
+    void stepStarted(const RevealTimeline::Step &step);
+
+    // Emitted every frame for the active step, progress runs from 0 to 1.
+    // A step that ends between two frames still gets a final frame at 1.
+    void frame(const RevealTimeline::Step &step, qreal progress);
+
+    void finished();
+
+private:
+    void tick();
+    void finish();
+
+    QVector<Step> steps;
+    int current;
+    qint64 time;
+    bool running;
+
+    double speedMultiplier;
+    double carry;
+    QTimer timer;
+    QElapsedTimer clock;
+    qint64 lastTick;
+};
+
+#endif // REVEALTIMELINE_H
@@ -0,0 +1,155 @@
+#include "soakrunner.h"
+#include "mainwindow.h"
+
+#include <QApplication>
+#include <QTimer>
+
+#include <algorithm>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_MACOS)
+#include <malloc/malloc.h>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+SoakRunner::SoakRunner(MainWindow *window, int iterations, qint64 toleranceBytes, std::FILE *out, QObject *parent)
+    : QObject(parent), window(window), iterations(iterations), toleranceBytes(toleranceBytes), out(out)
+{
+    // Queued so the window has dealt with the finished reveal before it is measured
+    connect(window, &MainWindow::lotteryFinished, this, &SoakRunner::next, Qt::QueuedConnection);
+}
+
+void SoakRunner::start(double speed)
+{
+    window->setKioskMode(true);
+    window->setRevealSpeed(speed);
+    window->loadDemoTeams();
+
+    std::fprintf(out, "iteration,objects,widgets,heap_bytes\n");
+    QTimer::singleShot(0, window, [this]()
+                       { startLottery(); });
+}
+
+// A lottery that refuses to start never finishes, so the run fails instead of waiting forever
+void SoakRunner::startLottery()
+{
+    if (window->startLottery())
+        return;
+
+    std::fprintf(stderr, "soak: lottery %d did not start, check that the odds add up to 100%%\n",
+                 static_cast<int>(samples.size()) + 1);
+    QCoreApplication::exit(1);
+}
+
+void SoakRunner::next()
+{
+    // Objects released with deleteLater count as gone
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+
+    Sample sample;
+    sample.iteration = samples.size() + 1;
+    sample.objects = window->findChildren<QObject *>().size();
+    sample.widgets = QApplication::allWidgets().size();
+    sample.heap = heapInUse();
+    samples.append(sample);
+
+    std::fprintf(out, "%d,%d,%d,%lld\n", sample.iteration, sample.objects, sample.widgets, static_cast<long long>(sample.heap));
+    std::fflush(out);
+
+    if (samples.size() < iterations)
+    {
+        startLottery();
+        return;
+    }
+
+    QCoreApplication::exit(evaluate() ? 0 : 1);
+}
+
+bool SoakRunner::evaluate() const
+{
+    int warmUp = std::max(1, iterations / 10);
+    if (samples.size() <= warmUp + 1)
+    {
+        std::fprintf(stderr, "soak: %d iterations are too few to judge, run at least %d\n", iterations, warmUp + 2);
+        return false;
+    }
+
+    const Sample &baseline = samples[warmUp - 1];
+    bool ok = true;
+
+    int maxObjects = 0;
+    int maxWidgets = 0;
+    for (int i = warmUp; i < samples.size(); ++i)
+    {
+        maxObjects = std::max(maxObjects, samples[i].objects);
+        maxWidgets = std::max(maxWidgets, samples[i].widgets);
+    }
+    if (maxObjects > baseline.objects || maxWidgets > baseline.widgets)
+    {
+        std::fprintf(stderr, "soak: objects grew from %d to %d, widgets from %d to %d\n", baseline.objects, maxObjects,
+                     baseline.widgets, maxWidgets);
+        ok = false;
+    }
+
+    // A single spike is allowed, growth along the whole run is not
+    if (baseline.heap >= 0)
+    {
+        double n = samples.size() - warmUp;
+        double meanX = 0.0;
+        double meanY = 0.0;
+        for (int i = warmUp; i < samples.size(); ++i)
+        {
+            meanX += i;
+            meanY += samples[i].heap;
+        }
+        meanX /= n;
+        meanY /= n;
+
+        double covariance = 0.0;
+        double variance = 0.0;
+        for (int i = warmUp; i < samples.size(); ++i)
+        {
+            covariance += (i - meanX) * (samples[i].heap - meanY);
+            variance += (i - meanX) * (i - meanX);
+        }
+        double slope = covariance / variance;
+        double growth = slope * (n - 1);
+
+        std::fprintf(stderr, "soak: heap trend %.1f bytes per lottery, %.0f KB over %d lotteries\n", slope, growth / 1024,
+                     static_cast<int>(n));
+        if (growth > toleranceBytes)
+        {
+            std::fprintf(stderr, "soak: heap grew more than %lld KB\n", static_cast<long long>(toleranceBytes / 1024));
+            ok = false;
+        }
+    }
+
+    std::fprintf(stderr, "soak: %s after %d lotteries\n", ok ? "flat" : "FAILED", static_cast<int>(samples.size()));
+    return ok;
+}
+
+qint64 SoakRunner::heapInUse()
+{
+#if defined(Q_OS_WIN)
+    // Private bytes, the closest cheap figure the process can get about itself
+    PROCESS_MEMORY_COUNTERS_EX counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS *>(&counters), sizeof(counters)))
+        return static_cast<qint64>(counters.PrivateUsage);
+    return -1;
+#elif defined(Q_OS_MACOS)
+    malloc_statistics_t stats;
+    malloc_zone_statistics(nullptr, &stats);
+    return static_cast<qint64>(stats.size_in_use);
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return static_cast<qint64>(info.uordblks + info.hblkhd);
+#elif defined(__GLIBC__)
+    struct mallinfo info = mallinfo();
+    return static_cast<qint64>(static_cast<unsigned int>(info.uordblks)) + static_cast<unsigned int>(info.hblkhd);
+#else
+    return -1;
+#endif
+}
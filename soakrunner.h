@@ -0,0 +1,50 @@
+#ifndef SOAKRUNNER_H
+#define SOAKRUNNER_H
+
+#include <QObject>
+#include <QVector>
+
+#include <cstdio>
+
+class MainWindow;
+
+// Runs the window's full lottery back to back for --soak, to prove an
+// all-day kiosk stays flat. After every reveal it samples the live objects
+// under the window, every widget in the application and the heap in use,
+// and writes one CSV line per iteration. The first tenth of the run warms
+// the caches up, after that any object growth fails the run, and so does
+// heap growth beyond the tolerance along the least-squares trend.
+class SoakRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    SoakRunner(MainWindow *window, int iterations, qint64 toleranceBytes, std::FILE *out, QObject *parent = nullptr);
+
+    // Starts the first lottery once the event loop runs, the application exits with 0 or 1 at the end
+    void start(double speed);
+
+    // Bytes the allocator has handed out and not had back, -1 where the platform can't tell
+    static qint64 heapInUse();
+
+private:
+    struct Sample
+    {
+        int iteration;
+        int objects;
+        int widgets;
+        qint64 heap;
+    };
+
+    void next();
+    void startLottery();
+    bool evaluate() const;
+
+    MainWindow *window;
+    int iterations;
+    qint64 toleranceBytes;
+    std::FILE *out;
+    QVector<Sample> samples;
+};
+
+#endif // SOAKRUNNER_H
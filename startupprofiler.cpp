@@ -0,0 +1,123 @@
+#include "startupprofiler.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QFile>
+#include <QMutexLocker>
+#include <QTimer>
+#include <QWidget>
+
+#include <cstdio>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#elif defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Time from process creation to now in nanoseconds, -1 where the platform can't tell.
+    // Covers loading the libraries, static initialization and resource registration.
+    qint64 processAgeNs()
+    {
+#ifdef Q_OS_WIN
+        FILETIME created, exited, kernel, user, now;
+        if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+            return -1;
+        GetSystemTimeAsFileTime(&now);
+
+        auto ticks = [](const FILETIME &time)
+        { return (qint64(time.dwHighDateTime) << 32) | time.dwLowDateTime; };
+        return (ticks(now) - ticks(created)) * 100;
+#elif defined(Q_OS_LINUX)
+        // Field 22 of /proc/self/stat is the start time in clock ticks since boot, only 10 ms resolution
+        QFile stat("/proc/self/stat");
+        QFile uptime("/proc/uptime");
+        if (!stat.open(QIODevice::ReadOnly) || !uptime.open(QIODevice::ReadOnly))
+            return -1;
+
+        QByteArray line = stat.readAll();
+        QList<QByteArray> fields = line.mid(line.lastIndexOf(')') + 2).split(' ');
+        if (fields.size() < 20)
+            return -1;
+
+        double started = fields[19].toDouble() / sysconf(_SC_CLK_TCK);
+        double up = uptime.readAll().split(' ').value(0).toDouble();
+        return static_cast<qint64>((up - started) * 1e9);
+#else
+        return -1;
+#endif
+    }
+}
+
+StartupProfiler::Scope::Scope(const char *phase)
+    : phase(phase), start(StartupProfiler::instance().isEnabled() ? StartupProfiler::instance().now() : 0)
+{
+}
+
+StartupProfiler::Scope::~Scope()
+{
+    StartupProfiler &profiler = StartupProfiler::instance();
+    if (profiler.isEnabled())
+        profiler.record(phase, start, profiler.now());
+}
+
+StartupProfiler &StartupProfiler::instance()
+{
+    static StartupProfiler profiler;
+    return profiler;
+}
+
+void StartupProfiler::start(bool enable)
+{
+    enabled = enable;
+    clock.start();
+
+    if (enabled)
+    {
+        qint64 age = processAgeNs();
+        if (age >= 0)
+            record("before main", -age, 0);
+    }
+}
+
+void StartupProfiler::record(const char *phase, qint64 startNs, qint64 endNs)
+{
+    QMutexLocker locker(&mutex);
+    phases.append(Phase{QString::fromLatin1(phase), startNs, endNs});
+}
+
+void StartupProfiler::watchFirstPaint(QWidget *window)
+{
+    if (enabled)
+        window->installEventFilter(this);
+}
+
+bool StartupProfiler::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() != QEvent::Paint)
+        return QObject::eventFilter(watched, event);
+
+    // Deliver the paint ourselves so the phase ends when it is done
+    watched->removeEventFilter(this);
+    qint64 start = now();
+    bool handled = watched->event(event);
+    record("first paint", start, now());
+
+    report();
+    QTimer::singleShot(0, qApp, &QCoreApplication::quit);
+    return handled;
+}
+
+void StartupProfiler::report() const
+{
+    QMutexLocker locker(&mutex);
+
+    std::fprintf(stderr, "%-20s %10s %10s\n", "phase", "start ms", "took ms");
+    for (const Phase &phase : phases)
+    {
+        std::fprintf(stderr, "%-20s %10.2f %10.2f\n", qPrintable(phase.name), phase.startNs / 1e6, (phase.endNs - phase.startNs) / 1e6);
+    }
+    std::fprintf(stderr, "%-20s %10.2f\n", "total", now() / 1e6);
+}
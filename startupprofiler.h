@@ -0,0 +1,64 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class QWidget;
+
+// Phase timings for --profile-startup.
+// main() starts the clock, each phase is timed with a Scope (from any thread)
+// and the report is printed once the watched window has painted for the
+// first time. When profiling is off, a Scope costs one flag check.
+class StartupProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Times the enclosing block as one phase
+    class Scope
+    {
+    public:
+        explicit Scope(const char *phase);
+        ~Scope();
+
+    private:
+        const char *phase;
+        qint64 start;
+    };
+
+    static StartupProfiler &instance();
+
+    void start(bool enabled);
+    bool isEnabled() const { return enabled; }
+
+    void record(const char *phase, qint64 startNs, qint64 endNs);
+    qint64 now() const { return clock.nsecsElapsed(); }
+
+    // Records the first paint of `window`, prints the report and quits
+    void watchFirstPaint(QWidget *window);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    StartupProfiler() = default;
+    void report() const;
+
+    struct Phase
+    {
+        QString name;
+        qint64 startNs;
+        qint64 endNs;
+    };
+
+    bool enabled = false;
+    QElapsedTimer clock;
+    mutable QMutex mutex;
+    QVector<Phase> phases;
+};
+
+#endif // STARTUPPROFILER_H
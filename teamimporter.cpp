@@ -0,0 +1,143 @@
+#include "teamimporter.h"
+
+#include <QFile>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace
+{
+    // Big enough to keep the number of model inserts low, small enough that
+    // each one is a short stop for the event loop
+    const int batchSize = 1000;
+}
+
+TeamImporter::TeamImporter(QObject *parent)
+    : QObject(parent), worker(nullptr), cancelled(false), generation(0)
+{
+    qRegisterMetaType<QVector<TeamTableModel::Team>>();
+}
+
+TeamImporter::~TeamImporter()
+{
+    cancel();
+    if (worker)
+    {
+        worker->wait();
+        delete worker;
+    }
+}
+
+void TeamImporter::importFile(const QString &path)
+{
+    start(path, QString());
+}
+
+void TeamImporter::importText(const QString &text)
+{
+    start(QString(), text);
+}
+
+void TeamImporter::cancel()
+{
+    cancelled = true;
+}
+
+void TeamImporter::start(const QString &path, const QString &text)
+{
+    if (worker)
+    {
+        cancel();
+        worker->wait();
+        worker->deleteLater();
+    }
+
+    cancelled = false;
+    quint64 import = ++generation;
+    worker = QThread::create([this, path, text, import]()
+                             { parse(path, text, import); });
+    worker->start();
+}
+
+// Queues a signal for the importer's thread, dropped there if a newer import has started
+template <typename Emit>
+void TeamImporter::post(quint64 import, Emit emitSignal)
+{
+    QMetaObject::invokeMethod(this, [this, import, emitSignal]()
+                              {
+        if (import == generation)
+            emitSignal(); }, Qt::QueuedConnection);
+}
+
+// Runs on the worker thread, every signal is posted back tagged with its import
+void TeamImporter::parse(const QString &path, const QString &text, quint64 import)
+{
+    QFile file;
+    QString source = text;
+    QTextStream stream(&source, QIODevice::ReadOnly);
+
+    if (!path.isEmpty())
+    {
+        file.setFileName(path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            QString message = QString("Could not open %1").arg(path);
+            post(import, [this, message]()
+                 { emit failed(message); });
+            return;
+        }
+        stream.setDevice(&file);
+    }
+
+    QVector<TeamTableModel::Team> batch;
+    batch.reserve(batchSize);
+    int imported = 0;
+    int skipped = 0;
+
+    QString line;
+    while (!cancelled && stream.readLineInto(&line))
+    {
+        line = line.trimmed();
+        if (line.isEmpty())
+            continue;
+
+        TeamTableModel::Team team;
+        int split = std::max(line.lastIndexOf('\t'), line.lastIndexOf(','));
+
+        if (split < 0)
+        {
+            // A bare name, odds can be filled in afterwards
+            team.name = line;
+        }
+        else
+        {
+            team.name = line.left(split).trimmed();
+
+            // Header rows and anything else without numeric odds
+            if (!TeamTableModel::parseOdds(line.mid(split + 1), team.odds))
+            {
+                ++skipped;
+                continue;
+            }
+        }
+
+        batch.append(team);
+        if (batch.size() == batchSize)
+        {
+            imported += batch.size();
+            post(import, [this, batch]()
+                 { emit batchReady(batch); });
+            batch.clear();
+        }
+    }
+
+    if (!batch.isEmpty())
+    {
+        imported += batch.size();
+        post(import, [this, batch]()
+             { emit batchReady(batch); });
+    }
+
+    post(import, [this, imported, skipped]()
+         { emit finished(imported, skipped); });
+}
@@ -0,0 +1,48 @@
+#ifndef TEAMIMPORTER_H
+#define TEAMIMPORTER_H
+
+#include "teamtablemodel.h"
+
+#include <QObject>
+#include <QThread>
+
+#include <atomic>
+
+// Parses pasted text or a CSV file of teams on a worker thread.
+// Each line is "name,odds" (a tab also works, for spreadsheet pastes), the
+// last separator splits the odds off so names may contain commas. Rows are
+// delivered in batches so the model can insert them without blocking the GUI.
+// Starting an import supersedes the running one, nothing it queued is delivered.
+class TeamImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TeamImporter(QObject *parent = nullptr);
+    ~TeamImporter();
+
+    void importFile(const QString &path);
+    void importText(const QString &text);
+
+    // Stops parsing, batches already queued are still delivered
+    void cancel();
+
+signals:
+    void batchReady(const QVector<TeamTableModel::Team> &teams);
+    void finished(int imported, int skipped);
+    void failed(const QString &message);
+
+private:
+    void start(const QString &path, const QString &text);
+    void parse(const QString &path, const QString &text, quint64 import);
+    template <typename Emit>
+    void post(quint64 import, Emit emitSignal);
+
+    QThread *worker;
+    std::atomic<bool> cancelled;
+
+    // Bumped by every start(), only read on the importer's thread
+    quint64 generation;
+};
+
+#endif // TEAMIMPORTER_H
@@ -0,0 +1,276 @@
+#include "teamtablemodel.h"
+
+#include <QBrush>
+#include <QFont>
+#include <QStringList>
+
+#include <algorithm>
+
+bool TeamTableModel::parseOdds(const QString &text, int &basisPoints)
+{
+    QString digits = text.trimmed();
+    if (digits.endsWith('%'))
+        digits.chop(1);
+
+    int point = digits.indexOf('.');
+    QString whole = point < 0 ? digits : digits.left(point);
+    QString fraction = point < 0 ? QString() : digits.mid(point + 1);
+
+    // Basis points only go down to hundredths of a percent
+    if ((whole.isEmpty() && fraction.isEmpty()) || fraction.size() > 2)
+        return false;
+
+    bool ok = true;
+    int percent = whole.isEmpty() ? 0 : whole.toInt(&ok);
+    if (!ok || percent < 0 || percent > 100)
+        return false;
+
+    int hundredths = 0;
+    if (!fraction.isEmpty())
+    {
+        hundredths = fraction.toInt(&ok);
+        if (!ok || fraction.startsWith('-') || fraction.startsWith('+'))
+            return false;
+        if (fraction.size() == 1)
+            hundredths *= 10;
+    }
+
+    basisPoints = percent * basisPointsPerPercent + hundredths;
+    return true;
+}
+
+QString TeamTableModel::formatOdds(int basisPoints)
+{
+    QString text = QString::number(basisPoints / basisPointsPerPercent);
+    int hundredths = basisPoints % basisPointsPerPercent;
+    if (hundredths != 0)
+    {
+        text += '.' + QString::number(hundredths).rightJustified(2, '0');
+        if (text.endsWith('0'))
+            text.chop(1);
+    }
+    return text + '%';
+}
+
+TeamTableModel::TeamTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int TeamTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : teams.size();
+}
+
+int TeamTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant TeamTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= teams.size())
+        return QVariant();
+
+    const Team &team = teams[index.row()];
+
+    switch (index.column())
+    {
+    case NameColumn:
+        // Empty names show the default name the draw will use, greyed out
+        if (role == Qt::DisplayRole)
+            return team.name.isEmpty() ? QString("Team %1").arg(index.row() + 1) : team.name;
+        if (role == Qt::EditRole)
+            return team.name;
+        if (role == Qt::ForegroundRole && team.name.isEmpty())
+            return QBrush(Qt::gray);
+        if (role == Qt::TextAlignmentRole)
+            return Qt::AlignCenter;
+        break;
+
+    case OddsColumn:
+        if (role == Qt::DisplayRole)
+            return team.odds != 0 ? formatOdds(team.odds) : QString();
+        if (role == Qt::EditRole)
+            return team.odds != 0 ? formatOdds(team.odds).chopped(1) : QString();
+        if (role == Qt::TextAlignmentRole)
+            return Qt::AlignCenter;
+        if (role == Qt::FontRole)
+        {
+            QFont font;
+            font.setBold(true);
+            return font;
+        }
+        break;
+
+    case PickOddsColumn:
+        if (!pickOdds.isValid() || index.row() >= pickOdds.teams() || team.odds <= 0)
+            break;
+
+        // Formatted on demand, so only visible rows pay for it
+        if (role == Qt::DisplayRole)
+            return QString("Top %1: %2%").arg(pickOdds.picks()).arg(pickOdds.topPicksProbability(index.row()) * 100.0, 0, 'f', 1);
+        if (role == Qt::ToolTipRole)
+        {
+            QStringList breakdown;
+            for (int pick = 0; pick < pickOdds.picks(); ++pick)
+            {
+                breakdown.append(QString("Pick %1: %2%").arg(pick + 1).arg(pickOdds.probability(index.row(), pick) * 100.0, 0, 'f', 2));
+            }
+            return breakdown.join("\n");
+        }
+        if (role == Qt::TextAlignmentRole)
+            return int(Qt::AlignVCenter | Qt::AlignLeft);
+        break;
+    }
+
+    return QVariant();
+}
+
+bool TeamTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || role != Qt::EditRole || index.row() >= teams.size())
+        return false;
+
+    Team &team = teams[index.row()];
+
+    if (index.column() == NameColumn)
+    {
+        team.name = value.toString().trimmed();
+        emit dataChanged(index, index);
+        return true;
+    }
+
+    if (index.column() == OddsColumn)
+    {
+        // Anything that isn't a number counts as no odds, like an empty field
+        int odds = 0;
+        if (!parseOdds(value.toString(), odds))
+            odds = 0;
+        if (odds == team.odds)
+            return true;
+
+        total += odds - team.odds;
+        team.odds = odds;
+        emit dataChanged(index, index);
+        emit oddsChanged();
+        return true;
+    }
+
+    return false;
+}
+
+Qt::ItemFlags TeamTableModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+
+    Qt::ItemFlags result = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    if (index.column() != PickOddsColumn)
+        result |= Qt::ItemIsEditable;
+    return result;
+}
+
+QVariant TeamTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    if (orientation == Qt::Vertical)
+        return section + 1;
+
+    switch (section)
+    {
+    case NameColumn:
+        return QString("Team Name");
+    case OddsColumn:
+        return QString("Odds");
+    case PickOddsColumn:
+        return QString("Pick Odds");
+    }
+    return QVariant();
+}
+
+void TeamTableModel::setRowCount(int count)
+{
+    count = std::max(0, count);
+
+    if (count > teams.size())
+    {
+        beginInsertRows(QModelIndex(), teams.size(), count - 1);
+        teams.resize(count);
+        endInsertRows();
+    }
+    else if (count < teams.size())
+    {
+        beginRemoveRows(QModelIndex(), count, teams.size() - 1);
+        for (int i = count; i < teams.size(); ++i)
+            total -= teams[i].odds;
+        teams.resize(count);
+        endRemoveRows();
+    }
+    else
+    {
+        return;
+    }
+
+    emit oddsChanged();
+}
+
+void TeamTableModel::appendTeams(const QVector<Team> &batch)
+{
+    if (batch.isEmpty())
+        return;
+
+    beginInsertRows(QModelIndex(), teams.size(), teams.size() + batch.size() - 1);
+    teams.append(batch);
+    for (const Team &team : batch)
+        total += team.odds;
+    endInsertRows();
+
+    emit oddsChanged();
+}
+
+void TeamTableModel::clear()
+{
+    beginResetModel();
+    teams.clear();
+    pickOdds = ExactPickOdds();
+    total = 0;
+    endResetModel();
+
+    emit oddsChanged();
+}
+
+std::vector<std::int64_t> TeamTableModel::weights() const
+{
+    std::vector<std::int64_t> result;
+    result.reserve(teams.size());
+    for (const Team &team : teams)
+    {
+        result.push_back(team.odds);
+    }
+    return result;
+}
+
+QVector<QPair<QString, int>> TeamTableModel::drawableTeams() const
+{
+    QVector<QPair<QString, int>> result;
+    for (int i = 0; i < teams.size(); ++i)
+    {
+        if (teams[i].odds > 0)
+        {
+            // If team name is empty, provide a default name
+            QString name = teams[i].name.isEmpty() ? QString("Team %1").arg(i + 1) : teams[i].name;
+            result.append(qMakePair(name, teams[i].odds));
+        }
+    }
+    return result;
+}
+
+void TeamTableModel::setPickOdds(const ExactPickOdds &odds)
+{
+    pickOdds = odds;
+    if (!teams.isEmpty())
+        emit dataChanged(index(0, PickOddsColumn), index(teams.size() - 1, PickOddsColumn), {Qt::DisplayRole, Qt::ToolTipRole});
+}
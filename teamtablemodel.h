@@ -0,0 +1,88 @@
+#ifndef TEAMTABLEMODEL_H
+#define TEAMTABLEMODEL_H
+
+#include "exactpickodds.h"
+
+#include <QAbstractTableModel>
+#include <QMetaType>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+#include <cstdint>
+#include <vector>
+
+// Team names and odds behind the team table.
+// The view only asks for rows it is showing and creates an editor only for
+// the cell being edited, so a raffle with thousands of entries costs no more
+// widgets than a 12-team league.
+class TeamTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column
+    {
+        NameColumn,
+        OddsColumn,
+        PickOddsColumn,
+        ColumnCount
+    };
+
+    // Odds are kept in basis points, 1250 is 12.5%, so totals add up exactly
+    static const int basisPointsPerPercent = 100;
+    static const int fullOdds = 100 * basisPointsPerPercent;
+
+    struct Team
+    {
+        QString name;
+        int odds = 0;
+    };
+
+    // Parses "12", "12.5" or "12.25%" into basis points without going through floating point
+    static bool parseOdds(const QString &text, int &basisPoints);
+
+    // Formats basis points as a percentage with only the decimals it needs, e.g. "12.5%"
+    static QString formatOdds(int basisPoints);
+
+    explicit TeamTableModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Grows or shrinks the list, keeping what was already entered
+    void setRowCount(int count);
+
+    // Inserts a batch of rows at the end in one go
+    void appendTeams(const QVector<Team> &teams);
+
+    void clear();
+
+    // Kept up to date as rows are edited, added and removed
+    qint64 totalOdds() const { return total; }
+
+    // One weight per row, rows without odds weigh 0
+    std::vector<std::int64_t> weights() const;
+
+    // Teams that can be drawn, empty names replaced by "Team N"
+    QVector<QPair<QString, int>> drawableTeams() const;
+
+    // Odds of landing in the first few picks, indexed like weights()
+    void setPickOdds(const ExactPickOdds &odds);
+
+signals:
+    void oddsChanged();
+
+private:
+    QVector<Team> teams;
+    ExactPickOdds pickOdds;
+    qint64 total = 0;
+};
+
+Q_DECLARE_METATYPE(TeamTableModel::Team)
+
+#endif // TEAMTABLEMODEL_H
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""Builds fonts/InterTight-Subset.ttf, the font the app embeds.
+
+Keeps Latin-1 and common punctuation plus the weight axis, and drops
+hinting and the other layout features, which cuts the embedded font to a
+fraction of the full Inter Tight file. Needs fontTools (pip install fonttools).
+
+    python3 tools/subsetfont.py path/to/InterTight-VariableFont_wght.ttf
+"""
+
+import argparse
+import os
+import sys
+
+from fontTools import subset
+
+# Printable ASCII, Latin-1 Supplement, and the dashes, quotes, bullet,
+# ellipsis and euro sign that team names and the cards use
+UNICODES = (
+    list(range(0x20, 0x7F))
+    + list(range(0xA0, 0x100))
+    + [0x2013, 0x2014, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2026, 0x20AC]
+)
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("font", help="full Inter Tight variable font")
+    parser.add_argument("--output", default=os.path.join(root, "fonts", "InterTight-Subset.ttf"))
+    args = parser.parse_args()
+
+    options = subset.Options()
+    options.layout_features = ["kern", "liga", "calt"]
+    options.hinting = False
+    options.name_IDs = ["*"]
+    options.notdef_outline = True
+
+    font = subset.load_font(args.font, options)
+    subsetter = subset.Subsetter(options)
+    subsetter.populate(unicodes=UNICODES)
+    subsetter.subset(font)
+
+    os.makedirs(os.path.dirname(args.output), exist_ok=True)
+    subset.save_font(font, args.output, options)
+
+    before = os.path.getsize(args.font)
+    after = os.path.getsize(args.output)
+    print(f"{args.output}: {after} bytes ({100 * after / before:.0f}% of {before})", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
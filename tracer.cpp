@@ -0,0 +1,179 @@
+#include "tracer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    struct Event
+    {
+        std::int64_t timestampNs;
+        const char *name;
+        std::int64_t value;
+        Tracer::Type type;
+    };
+
+    // Written only by its own thread, read by writeChromeJson once the thread is idle.
+    // When full the oldest events are overwritten, the trace keeps the most recent ones.
+    struct ThreadBuffer
+    {
+        static const std::uint64_t capacity = 1 << 16;
+
+        std::unique_ptr<Event[]> events{new Event[capacity]};
+        std::atomic<std::uint64_t> head{0};
+        int id = 0;
+        const char *name = nullptr;
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        std::atomic<std::int64_t> epochNs{0};
+    };
+
+    Registry &registry()
+    {
+        static Registry instance;
+        return instance;
+    }
+
+    thread_local ThreadBuffer *threadBuffer = nullptr;
+
+    std::int64_t steadyNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // The only lock a trace point ever takes, once per thread
+    ThreadBuffer *currentBuffer()
+    {
+        if (!threadBuffer)
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.buffers.push_back(std::make_unique<ThreadBuffer>());
+            threadBuffer = r.buffers.back().get();
+            threadBuffer->id = static_cast<int>(r.buffers.size());
+        }
+        return threadBuffer;
+    }
+
+    // Names are our own literals, only quotes and backslashes need escaping
+    void writeString(std::FILE *file, const char *text)
+    {
+        std::fputc('"', file);
+        for (const char *c = text; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+                std::fputc('\\', file);
+            std::fputc(*c, file);
+        }
+        std::fputc('"', file);
+    }
+}
+
+std::atomic<bool> Tracer::recording{false};
+
+// Clears whatever an earlier recording left, so call it while the traced threads are idle
+void Tracer::start()
+{
+    Registry &r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const std::unique_ptr<ThreadBuffer> &buffer : r.buffers)
+            buffer->head.store(0, std::memory_order_relaxed);
+    }
+
+    // The starting thread's buffer is allocated now rather than at its first trace point
+    currentBuffer();
+    r.epochNs.store(steadyNs(), std::memory_order_relaxed);
+    recording.store(true, std::memory_order_release);
+}
+
+void Tracer::stop()
+{
+    recording.store(false, std::memory_order_release);
+}
+
+void Tracer::record(Type type, const char *name, std::int64_t value)
+{
+    ThreadBuffer *buffer = currentBuffer();
+    std::uint64_t head = buffer->head.load(std::memory_order_relaxed);
+
+    Event &event = buffer->events[head & (ThreadBuffer::capacity - 1)];
+    event.timestampNs = steadyNs() - registry().epochNs.load(std::memory_order_relaxed);
+    event.name = name;
+    event.value = value;
+    event.type = type;
+
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::setThreadName(const char *name)
+{
+    currentBuffer()->name = name;
+}
+
+bool Tracer::writeChromeJson(const std::string &path, std::string &error)
+{
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        error = "Could not write " + path;
+        return false;
+    }
+
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+    bool first = true;
+    auto separate = [file, &first]()
+    {
+        if (!first)
+            std::fputs(",\n", file);
+        first = false;
+    };
+
+    for (const std::unique_ptr<ThreadBuffer> &buffer : r.buffers)
+    {
+        separate();
+        std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", buffer->id);
+        if (buffer->name)
+            writeString(file, buffer->name);
+        else
+            std::fprintf(file, "\"thread %d\"", buffer->id);
+        std::fputs("}}", file);
+
+        std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+        std::uint64_t count = head < ThreadBuffer::capacity ? head : ThreadBuffer::capacity;
+        for (std::uint64_t i = head - count; i < head; ++i)
+        {
+            const Event &event = buffer->events[i & (ThreadBuffer::capacity - 1)];
+            static const char phases[] = {'B', 'E', 'i', 'C'};
+
+            separate();
+            std::fputs("{\"name\":", file);
+            writeString(file, event.name);
+            std::fprintf(file, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d", phases[static_cast<int>(event.type)],
+                         event.timestampNs / 1000.0, buffer->id);
+            if (event.type == Type::Instant)
+                std::fprintf(file, ",\"s\":\"t\",\"args\":{\"value\":%lld}", static_cast<long long>(event.value));
+            else if (event.type == Type::Counter)
+                std::fprintf(file, ",\"args\":{\"value\":%lld}", static_cast<long long>(event.value));
+            std::fputc('}', file);
+        }
+    }
+
+    std::fputs("]}\n", file);
+    if (std::fclose(file) != 0)
+    {
+        error = "Could not write " + path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,119 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Highest trace level compiled in: 0 removes every trace point, 1 keeps the
+// lottery and reveal steps, 2 adds per-frame spans and counters
+#ifndef DRAFTLOTTERY_TRACE_LEVEL
+#define DRAFTLOTTERY_TRACE_LEVEL 1
+#endif
+
+// Structured tracing of the lottery pipeline for --trace.
+// Trace points store a fixed-size binary event (timestamp, static name,
+// one integer) in a ring buffer owned by the calling thread, so recording
+// takes no lock, allocates nothing and formats nothing, and a whole reveal
+// can be traced without changing its timing. While recording is off a trace
+// point costs one relaxed load, and levels above DRAFTLOTTERY_TRACE_LEVEL
+// compile to nothing. The buffers are written out as Chrome trace JSON,
+// which chrome://tracing and ui.perfetto.dev open directly.
+class Tracer
+{
+public:
+    enum Level
+    {
+        Reveal = 1,
+        Frame = 2
+    };
+
+    enum class Type : std::uint32_t
+    {
+        Begin,
+        End,
+        Instant,
+        Counter
+    };
+
+    static void start();
+    static void stop();
+    static bool isRecording() { return recording.load(std::memory_order_relaxed); }
+
+    // `name` must outlive the trace, in practice a string literal
+    static void record(Type type, const char *name, std::int64_t value = 0);
+
+    // Names the calling thread's track in the trace, `name` must be a string literal
+    static void setThreadName(const char *name);
+
+    // Writes every thread's buffered events, call after the traced threads are idle.
+    // Returns false with a message if the file can't be written.
+    static bool writeChromeJson(const std::string &path, std::string &error);
+
+private:
+    static std::atomic<bool> recording;
+};
+
+// Records a span for the enclosing block when Enabled
+template <bool Enabled>
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *) {}
+};
+
+template <>
+class TraceScope<true>
+{
+public:
+    // A span that began while recording always gets its end, so spans stay balanced
+    explicit TraceScope(const char *name)
+        : name(Tracer::isRecording() ? name : nullptr)
+    {
+        if (this->name)
+            Tracer::record(Tracer::Type::Begin, this->name);
+    }
+
+    ~TraceScope()
+    {
+        if (name)
+            Tracer::record(Tracer::Type::End, name);
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+// Times the enclosing block as a span
+#define TRACE_SCOPE(level, name) \
+    TraceScope<((level) <= DRAFTLOTTERY_TRACE_LEVEL)> TRACE_CONCAT(traceScope, __LINE__)(name)
+
+// A point in time with one value attached
+#define TRACE_INSTANT(level, name, value)                                         \
+    do                                                                            \
+    {                                                                             \
+        if constexpr ((level) <= DRAFTLOTTERY_TRACE_LEVEL)                        \
+        {                                                                         \
+            if (Tracer::isRecording())                                            \
+                Tracer::record(Tracer::Type::Instant, name, (value));             \
+        }                                                                         \
+    } while (0)
+
+// A value plotted over time as its own track
+#define TRACE_COUNTER(level, name, value)                                         \
+    do                                                                            \
+    {                                                                             \
+        if constexpr ((level) <= DRAFTLOTTERY_TRACE_LEVEL)                        \
+        {                                                                         \
+            if (Tracer::isRecording())                                            \
+                Tracer::record(Tracer::Type::Counter, name, (value));             \
+        }                                                                         \
+    } while (0)
+
+#endif // TRACER_H